@@ -7,6 +7,8 @@ AR  ?= ar
 CC  ?= gcc
 CXX ?= g++
 
+ROOT_DIR := $(patsubst %/,%,$(dir $(lastword $(MAKEFILE_LIST))))
+
 # --------------------------------------------------------------
 # Fallback to Linux if no other OS defined
 
@@ -43,15 +45,77 @@ BASE_FLAGS += -DNDEBUG $(BASE_OPTS) -fvisibility=hidden -O3
 CXXFLAGS   += -fvisibility-inlines-hidden
 endif
 
+# --------------------------------------------------------------
+# 32-bit ARM has no runtime dispatch, see dsp/dsp_dispatch.h, so NEON is selected at build time
+# 'make NEON=false' builds for ARM cores without it
+
+TARGET_MACHINE := $(shell $(CC) -dumpmachine)
+
+ifneq (,$(filter arm%,$(TARGET_MACHINE)))
+ifneq ($(NEON),false)
+BASE_FLAGS += -mfpu=neon
+endif
+endif
+
+# --------------------------------------------------------------
+# Profile guided optimization and LTO, 'make PGO=true' at the top level runs the whole flow
+# PGO=generate builds instrumented plugins, PGO=use rebuilds them with the recorded profile
+
+PGO_DIR = $(abspath $(ROOT_DIR))/pgo-profile
+
+ifeq ($(PGO),generate)
+BASE_FLAGS += -fprofile-generate=$(PGO_DIR) -fno-profile-values
+else ifeq ($(PGO),use)
+BASE_FLAGS += -fprofile-use=$(PGO_DIR) -fprofile-correction -Wno-missing-profile
+endif
+
+ifeq ($(LTO),true)
+BASE_FLAGS += -flto
+# the static DSP library needs an archiver that keeps the LTO sections
+ifneq (,$(findstring clang,$(CC)))
+AR = llvm-ar
+else
+AR = gcc-ar
+endif
+endif
+
+# --------------------------------------------------------------
+# Hot path counters published to shared memory, read them with tools/dsp-stats
+
+ifeq ($(STATS),true)
+BASE_FLAGS += -DDSP_STATS
+ifeq ($(LINUX),true)
+LDFLAGS    += -lrt
+endif
+endif
+
+# --------------------------------------------------------------
+# Lock the per instance arena of every plugin in RAM, see dsp/dsp_arena.h
+
+ifeq ($(MLOCK),true)
+BASE_FLAGS += -DDSP_ARENA_MLOCK
+endif
+
+# --------------------------------------------------------------
+# Run the gate key at 1/4 rate from 96kHz and 1/8 from 192kHz, see Gate_KeyDecimation in dsp/gate_core.h
+
+ifeq ($(KEY_DECIMATION),true)
+BASE_FLAGS += -DDSP_GATE_KEY_DECIMATION
+endif
+
 BUILD_C_FLAGS   = $(BASE_FLAGS) -std=c99 -std=gnu99 $(CFLAGS)
+
+# the plugins are linked without -ffast-math, gcc would add crtfastmath.o and its constructor turns on
+# flush-to-zero for the host thread that loads the plugin; run() sets it itself, see dsp/dsp_denormal.h
+BUILD_LINK_FLAGS = $(filter-out -ffast-math,$(BUILD_C_FLAGS))
 BUILD_CXX_FLAGS = $(BASE_FLAGS) -std=c++11 $(CXXFLAGS) $(CPPFLAGS)
 
 ifeq ($(MACOS),true)
 # 'no-undefined' is always enabled on MacOS
 LINK_FLAGS      = $(LINK_OPTS) $(LDFLAGS)
 else
-# add 'no-undefined'
-LINK_FLAGS      = $(LINK_OPTS) -Wl,--no-undefined $(LDFLAGS)
+# add 'no-undefined', symbols of the static DSP library stay local to each plugin
+LINK_FLAGS      = $(LINK_OPTS) -Wl,--no-undefined -Wl,--exclude-libs,ALL $(LDFLAGS)
 endif
 
 # --------------------------------------------------------------
@@ -75,3 +139,36 @@ SHARED = -shared
 endif
 
 # --------------------------------------------------------------
+
+# --------------------------------------------------------------
+# Shared DSP library, linked into every plugin
+
+# the rules below must not become the default target of the including makefile
+.DEFAULT_GOAL := all
+
+DSP_DIR   = $(ROOT_DIR)/dsp
+DSP_LIB   = $(DSP_DIR)/libmoddsp.a
+DSP_SRC   = $(DSP_DIR)/compressor_core.c $(DSP_DIR)/gate_core.c $(DSP_DIR)/circular_buffer.c $(DSP_DIR)/dsp_stats.c \
+            $(DSP_DIR)/dsp_arena.c $(DSP_DIR)/dynamics.c $(DSP_TABLES)
+DSP_OBJ   = $(DSP_SRC:%.c=%.o)
+DSP_FLAGS = -I$(DSP_DIR)
+
+# lookup tables written at build time by gen-tables, which runs on the build machine
+HOST_CC    ?= cc
+DSP_TABLES  = $(DSP_DIR)/dsp_tables.c
+DSP_GEN     = $(DSP_DIR)/gen-tables
+
+$(DSP_GEN): $(DSP_DIR)/gen-tables.c $(DSP_DIR)/dsp_tables.h
+	$(HOST_CC) $< -O2 -std=gnu99 -Wall -Wextra -I$(DSP_DIR) -lm -o $@
+
+$(DSP_TABLES): $(DSP_GEN)
+	$(DSP_GEN) $@
+
+$(DSP_OBJ): %.o: %.c $(wildcard $(DSP_DIR)/*.h)
+	$(CC) $< $(BUILD_C_FLAGS) -c -o $@
+
+$(DSP_LIB): $(DSP_OBJ)
+	rm -f $@
+	$(AR) crs $@ $^
+
+# --------------------------------------------------------------
@@ -0,0 +1,140 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "corpus.h"
+
+#define NOISE_BURST_MS 100
+#define NOISE_GAP_MS 150
+#define PLUCK_INTERVAL_MS 250
+#define SWEEP_LOW_HZ 20.0
+#define SWEEP_HIGH_HZ 20000.0
+
+const char *const corpus_names[CORPUS_COUNT] = {
+    "silence",
+    "noise_bursts",
+    "plucks",
+    "sweep",
+};
+
+//xorshift32, fixed seed so every run sees the same samples
+static uint32_t corpus_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static float corpus_noise(uint32_t *state)
+{
+    return (float)corpus_rand(state) * (2.0f / 4294967295.0f) - 1.0f;
+}
+
+//full scale bursts at -12 dBFS over a -80 dBFS noise floor
+static void corpus_noise_bursts(float *out, uint32_t sample_rate, uint32_t length)
+{
+    const uint32_t burst = sample_rate * NOISE_BURST_MS / 1000;
+    const uint32_t period = burst + sample_rate * NOISE_GAP_MS / 1000;
+    uint32_t seed = 0x12345678;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        const float level = (i % period) < burst ? 0.25f : 0.0001f;
+        out[i] = corpus_noise(&seed) * level;
+    }
+}
+
+//Karplus-Strong strings on a pentatonic scale, a new pluck every interval at a random velocity
+static void corpus_plucks(float *out, uint32_t sample_rate, uint32_t length)
+{
+    static const float notes[] = { 82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f };
+    const uint32_t interval = sample_rate * PLUCK_INTERVAL_MS / 1000;
+    const uint32_t max_period = sample_rate / 80 + 1;
+    float *line = (float *)calloc(max_period, sizeof(float));
+    uint32_t period = 1, pos = 0, seed = 0x9e3779b9;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (i % interval == 0)
+        {
+            const float velocity = 0.1f + 0.8f * (corpus_noise(&seed) * 0.5f + 0.5f);
+            period = (uint32_t)(sample_rate / notes[corpus_rand(&seed) % 6]);
+            pos = 0;
+            for (uint32_t j = 0; j < period; j++)
+                line[j] = corpus_noise(&seed) * velocity;
+        }
+
+        const uint32_t next = (pos + 1) % period;
+        const float sample = line[pos];
+        line[pos] = 0.498f * (sample + line[next]);
+        pos = next;
+        out[i] = sample;
+    }
+
+    free(line);
+}
+
+//exponential sine sweep while the level rises from -80 dBFS to 0 dBFS, crosses every threshold once
+static void corpus_sweep(float *out, uint32_t sample_rate, uint32_t length)
+{
+    const double duration = (double)length / sample_rate;
+    const double k = log(SWEEP_HIGH_HZ / SWEEP_LOW_HZ);
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        const double t = (double)i / sample_rate;
+        const double phase = 2.0 * M_PI * SWEEP_LOW_HZ * duration / k * (exp(t / duration * k) - 1.0);
+        const double level = pow(10.0, (-80.0 + 80.0 * t / duration) / 20.0);
+        out[i] = (float)(sin(phase) * level);
+    }
+}
+
+int corpus_init(corpus_t *corpus, uint32_t sample_rate, uint32_t length)
+{
+    memset(corpus, 0, sizeof(*corpus));
+    corpus->length = length;
+
+    for (int s = 0; s < CORPUS_COUNT; s++)
+    {
+        corpus->signals[s] = (float *)calloc(length, sizeof(float));
+        if (!corpus->signals[s])
+        {
+            corpus_free(corpus);
+            return 0;
+        }
+    }
+
+    corpus_noise_bursts(corpus->signals[CORPUS_NOISE_BURSTS], sample_rate, length);
+    corpus_plucks(corpus->signals[CORPUS_PLUCKS], sample_rate, length);
+    corpus_sweep(corpus->signals[CORPUS_SWEEP], sample_rate, length);
+
+    return 1;
+}
+
+void corpus_free(corpus_t *corpus)
+{
+    for (int s = 0; s < CORPUS_COUNT; s++)
+    {
+        free(corpus->signals[s]);
+        corpus->signals[s] = NULL;
+    }
+}
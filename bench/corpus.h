@@ -0,0 +1,44 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+// deterministic test signals the plugin benchmarks run over
+
+#ifndef CORPUS_H_INCLUDED
+#define CORPUS_H_INCLUDED
+
+#include <stdint.h>
+
+typedef enum {
+    CORPUS_SILENCE,
+    CORPUS_NOISE_BURSTS,
+    CORPUS_PLUCKS,
+    CORPUS_SWEEP,
+    CORPUS_COUNT
+} corpus_signal_t;
+
+typedef struct {
+    uint32_t length;                    //samples per signal
+    float *signals[CORPUS_COUNT];
+} corpus_t;
+
+extern const char *const corpus_names[CORPUS_COUNT];
+
+//generates every signal with length samples at sample_rate, returns 1 on success
+int corpus_init(corpus_t *corpus, uint32_t sample_rate, uint32_t length);
+void corpus_free(corpus_t *corpus);
+
+#endif //CORPUS_H_INCLUDED
@@ -0,0 +1,258 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// per-sample cost of the gate detectors over window sizes, both should stay flat
+// with -s hours the average detector runs that much simulated audio against a double precision
+// sliding mean instead, and fails if the error ever grows past the fixed point quantization
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <float.h>
+
+#include "circular_buffer.h"
+#include "gate_core.h"
+
+#define BENCH_SAMPLES (1 << 22)
+#define BENCH_BLOCK_SIZE 64
+
+#define SOAK_SAMPLE_RATE 48000
+#define SOAK_SEGMENT (BENCH_BLOCK_SIZE * 256)
+
+typedef float (*detector_fn)(ringbuffer_t *buffer, const float input);
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double run_detector(detector_fn fn, uint32_t size, const float *signal)
+{
+    ringbuffer_t window;
+    volatile float sink = 0.0f;
+
+    if (!ringbuffer_init(&window, size, NULL))
+        return -1.0;
+
+    const double start = now_ns();
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+        sink += fn(&window, signal[i]);
+
+    const double elapsed = now_ns() - start;
+
+    ringbuffer_free(&window);
+    (void)sink;
+
+    return elapsed / BENCH_SAMPLES;
+}
+
+static double run_block_detector(uint32_t size, const float *signal)
+{
+    ringbuffer_t window;
+    float power[BENCH_BLOCK_SIZE];
+    volatile float sink = 0.0f;
+
+    if (!ringbuffer_init(&window, size, NULL))
+        return -1.0;
+
+    const double start = now_ns();
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i += BENCH_BLOCK_SIZE)
+    {
+        ringbuffer_push_and_calculate_power_block(&window, signal + i, power, BENCH_BLOCK_SIZE);
+        sink += power[BENCH_BLOCK_SIZE - 1];
+    }
+
+    const double elapsed = now_ns() - start;
+
+    ringbuffer_free(&window);
+    (void)sink;
+
+    return elapsed / BENCH_SAMPLES;
+}
+
+//noise at a level that changes every third of a second, from silence and denormals to clipping
+//far above the +12dBFS clamp of the window, so the sum spends long stretches at its clamped maximum
+static float soak_level(uint32_t *seed)
+{
+    static const float levels[] = { 0.0f, 1e-40f, 1e-7f, 1e-4f, 0.01f, 0.3f, 1.0f, 3.99f, 100.0f };
+
+    *seed = *seed * 1664525u + 1013904223u;
+    return levels[(*seed >> 16) % (sizeof(levels) / sizeof(levels[0]))];
+}
+
+static float soak_noise(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return (float)(*seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static int soak_window(uint32_t size, double hours)
+{
+    const uint64_t samples = (uint64_t)(hours * 3600.0 * SOAK_SAMPLE_RATE);
+    const uint64_t hour = 3600ull * SOAK_SAMPLE_RATE;
+    const double clamp = RINGBUFFER_FIXED_MAX / RINGBUFFER_FIXED_SCALE;
+    //half a step of rounding per sample at most, plus the float conversions of the mean
+    const double bound = 1.0 / RINGBUFFER_FIXED_SCALE;
+    ringbuffer_t single, block;
+    float input[BENCH_BLOCK_SIZE], power[BENCH_BLOCK_SIZE];
+    double worst_hour = 0.0, worst = 0.0, first_hour = 0.0;
+    uint32_t seed = size, pos = 0;
+    float level = 0.0f;
+    double sum = 0.0;
+    int ok = 1;
+
+    double *window = (double *)calloc(size, sizeof(double));
+    if (!window || !ringbuffer_init(&single, size, NULL))
+    {
+        free(window);
+        return 0;
+    }
+    if (!ringbuffer_init(&block, size, NULL))
+    {
+        ringbuffer_free(&single);
+        free(window);
+        return 0;
+    }
+
+    printf("%8s %8s %14s\n", "window", "hour", "max error");
+
+    for (uint64_t n = 0; n < samples; n += BENCH_BLOCK_SIZE)
+    {
+        if (n % SOAK_SEGMENT == 0)
+            level = soak_level(&seed);
+
+        for (uint32_t i = 0; i < BENCH_BLOCK_SIZE; i++)
+            input[i] = soak_noise(&seed) * level;
+
+        ringbuffer_push_and_calculate_power_block(&block, input, power, BENCH_BLOCK_SIZE);
+
+        for (uint32_t i = 0; i < BENCH_BLOCK_SIZE; i++)
+        {
+            const float mean = ringbuffer_push_and_calculate_power(&single, input[i]);
+            const double x = fabs((double)input[i]);
+
+            //the reference sum is recomputed from the window once per lap, so it cannot drift itself
+            sum += (x < clamp ? x : clamp) - window[pos];
+            window[pos] = x < clamp ? x : clamp;
+            if (++pos == size)
+            {
+                pos = 0;
+                sum = 0.0;
+                for (uint32_t j = 0; j < size; j++)
+                    sum += window[j];
+            }
+
+            const double reference = sum / size;
+            const double limit = bound + 4.0 * FLT_EPSILON * reference;
+            const double error = fabs((double)mean - reference);
+            const double block_error = fabs((double)power[i] - reference);
+
+            if (error > worst_hour)
+                worst_hour = error;
+            if (block_error > worst_hour)
+                worst_hour = block_error;
+
+            if (ok && (error > limit || block_error > limit))
+            {
+                fprintf(stderr, "window %u: error %g above %g after %.3f hours\n", size,
+                        error > block_error ? error : block_error, limit, (double)(n + i) / hour);
+                ok = 0;
+            }
+        }
+
+        if ((n + BENCH_BLOCK_SIZE) % hour == 0 || n + BENCH_BLOCK_SIZE >= samples)
+        {
+            const uint64_t h = (n + BENCH_BLOCK_SIZE + hour - 1) / hour;
+
+            printf("%8u %8llu %14.3e\n", size, (unsigned long long)h, worst_hour);
+            if (h == 1)
+                first_hour = worst_hour;
+            if (worst_hour > worst)
+                worst = worst_hour;
+            worst_hour = 0.0;
+        }
+    }
+
+    //a drifting sum shows as an error that grows hour after hour
+    printf("%8u %8s %14.3e (first hour %.3e, bound %.3e)\n", size, "all", worst, first_hour, bound);
+
+    ringbuffer_free(&block);
+    ringbuffer_free(&single);
+    free(window);
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    double hours = 0.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': hours = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-s hours]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (hours > 0.0)
+    {
+        //the window the plugins use at the soak rate and the largest one
+        const uint32_t window = Gate_WindowSize(SOAK_SAMPLE_RATE, GATE_DEFAULT_WINDOW_MS, 1);
+        const int ok = soak_window(window, hours) & soak_window(RINGBUFFER_MAX_SIZE, hours);
+        return !ok;
+    }
+
+    float *signal = (float*)malloc(BENCH_SAMPLES * sizeof(float));
+    uint32_t seed = 1;
+
+    if (signal == NULL)
+        return 1;
+
+    // decaying noise bursts, the falling tails are the worst case for the peak deque
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const float noise = (float)(seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        signal[i] = noise * expf(-(float)(i % 24000) * 0.0005f);
+    }
+
+    printf("%8s %14s %14s %14s\n", "window", "average ns/s", "block ns/s", "peak ns/s");
+
+    for (uint32_t size = 64; size <= RINGBUFFER_MAX_SIZE; size *= 2)
+    {
+        const double average = run_detector(ringbuffer_push_and_calculate_power, size, signal);
+        const double block = run_block_detector(size, signal);
+        const double peak = run_detector(ringbuffer_push_and_calculate_peak, size, signal);
+
+        printf("%8u %14.3f %14.3f %14.3f\n", size, average, block, peak);
+    }
+
+    free(signal);
+    return 0;
+}
@@ -0,0 +1,422 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+// isolated cost of the dsp kernels, with hardware counters where the kernel lets us read them
+// the dsp sources are included directly so the static helpers (compcurve) can be reached
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "compressor_core.c"
+#include "circular_buffer.c"
+#include "dsp_arena.c"
+#include "dsp_tables.c"
+#include "gate_core.c"
+
+#define BENCH_SAMPLE_RATE 48000
+#define BENCH_WARM_OPS 2000000
+#define BENCH_COLD_RUNS 200
+#define BENCH_EVICT_BYTES (32 << 20)
+#define BENCH_CHUNK 64
+#define BENCH_CURVE_POINTS 256
+
+enum {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_L1D_MISSES,
+    COUNTER_COUNT
+};
+
+typedef struct {
+    int fd[COUNTER_COUNT];
+    uint64_t value[COUNTER_COUNT];
+} counters_t;
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    uint32_t ops;           //ops per call of run
+    void (*setup)(void);
+    void (*run)(void);
+} kernel_t;
+
+static volatile float sink;
+static float *evict_buffer;
+static float curve_points[BENCH_CURVE_POINTS];
+static float chunk_l[BENCH_CHUNK], chunk_r[BENCH_CHUNK];
+static float out_l[BENCH_CHUNK], out_r[BENCH_CHUNK];
+static sf_compressor_state_st compressor;
+static ringbuffer_t window;
+static gate_t gate;
+static uint32_t param_step;
+static dsp_telemetry_t telemetry;
+static pthread_t telemetry_reader;
+static volatile int telemetry_polling;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// --------------------------------------------------------------
+// hardware counters, every counter is opened on its own so a missing one does not take the others down
+
+#ifdef __linux__
+static int counter_open(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static int counters_open(counters_t *counters)
+{
+    int opened = 0;
+
+    for (int i = 0; i < COUNTER_COUNT; i++)
+        counters->fd[i] = -1;
+
+#ifdef __linux__
+    counters->fd[COUNTER_CYCLES] = counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    counters->fd[COUNTER_INSTRUCTIONS] = counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    counters->fd[COUNTER_BRANCH_MISSES] = counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    counters->fd[COUNTER_L1D_MISSES] = counter_open(PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+    for (int i = 0; i < COUNTER_COUNT; i++)
+        opened += counters->fd[i] >= 0;
+#endif
+
+    return opened;
+}
+
+static void counters_close(counters_t *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (counters->fd[i] >= 0)
+            close(counters->fd[i]);
+    }
+#endif
+    (void)counters;
+}
+
+static void counters_clear(counters_t *counters)
+{
+    memset(counters->value, 0, sizeof(counters->value));
+}
+
+static inline void counters_start(counters_t *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (counters->fd[i] >= 0)
+        {
+            ioctl(counters->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+    (void)counters;
+}
+
+//accumulates, so a cold measurement can sum many single calls
+static inline void counters_stop(counters_t *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (counters->fd[i] >= 0)
+            ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        uint64_t value;
+        if (counters->fd[i] >= 0 && read(counters->fd[i], &value, sizeof(value)) == sizeof(value))
+            counters->value[i] += value;
+    }
+#endif
+    (void)counters;
+}
+
+// --------------------------------------------------------------
+// kernels
+
+static void setup_compressor(void)
+{
+    compressor_init(&compressor, BENCH_SAMPLE_RATE);
+    compressor_set_params(&compressor, -30.0f, 10.0f, 4.0f, 0.003f, 0.1f, 0.0f);
+}
+
+static void run_compcurve(void)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < BENCH_CURVE_POINTS; i++)
+        acc += compcurve(curve_points[i], compressor.k, compressor.slope, compressor.linearthreshold,
+                         compressor.linearthresholdknee, compressor.threshold, compressor.knee,
+                         compressor.kneedboffset);
+    sink = acc;
+}
+
+static void run_compressor_process(void)
+{
+    compressor_process(&compressor, SF_COMPRESSOR_SPU, chunk_l, chunk_r, out_l, out_r);
+    sink = out_l[0];
+}
+
+//alternates between two knob positions, like a host automating the release
+static void run_compressor_set_params(void)
+{
+    const float release = (param_step++ & 1) ? 0.1f : 0.5f;
+    compressor_set_params(&compressor, -30.0f, 10.0f, 4.0f, 0.003f, release, 0.0f);
+    sink = compressor.a;
+}
+
+static void setup_ringbuffer(void)
+{
+    ringbuffer_clear(&window);
+}
+
+static void run_ringbuffer_power(void)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < BENCH_CHUNK; i++)
+        acc += ringbuffer_push_and_calculate_power(&window, chunk_l[i]);
+    sink = acc;
+}
+
+//each setup pins the state machine to one branch for the whole measurement:
+//the attack and decay times are pushed out of reach so the counters never complete
+static void setup_gate(gate_state_t state, float key, int attacking)
+{
+    Gate_UpdateParameters(&gate, BENCH_SAMPLE_RATE, 10, 10, 10, 1, -60.0f, -70.0f);
+    gate._currentState = state;
+    gate._keyValue = key;
+    gate._attackCounter = attacking;
+    gate._holdCounter = 0;
+    gate._decayCounter = 1;
+    gate._attackTime = UINT32_MAX / 2;
+    gate._decayTime = UINT32_MAX / 2;
+    gate._holdTime = UINT32_MAX / 2;
+}
+
+static void setup_gate_closed(void) { setup_gate(IDLE, 0.0f, 0); }
+static void setup_gate_attack(void) { setup_gate(IDLE, 1.0f, 1); }
+static void setup_gate_hold(void)   { setup_gate(HOLD, 1.0f, 0); }
+static void setup_gate_decay(void)  { setup_gate(DECAY, 0.0f, 0); }
+
+static void run_gate(void)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < BENCH_CHUNK; i++)
+        acc += Gate_RunGate(&gate, chunk_l[i]);
+    sink = acc;
+}
+
+static void setup_telemetry(void)
+{
+    dsp_telemetry_init(&telemetry);
+}
+
+static void run_telemetry_publish(void)
+{
+    telemetry.current.gain_sum += 0.5;
+    dsp_telemetry_publish(&telemetry, BENCH_CHUNK);
+}
+
+//another core reads as fast as it can, a UI or the host polling much more often than it would
+static void *telemetry_poll(void *arg)
+{
+    dsp_telemetry_values_t values;
+
+    (void)arg;
+    while (telemetry_polling)
+        dsp_telemetry_read(&telemetry, &values, 1);
+
+    return NULL;
+}
+
+//the reader keeps going until main stops it, so this has to be the last kernel
+static void setup_telemetry_polled(void)
+{
+    setup_telemetry();
+    if (!telemetry_polling)
+    {
+        telemetry_polling = 1;
+        if (pthread_create(&telemetry_reader, NULL, telemetry_poll, NULL) != 0)
+            telemetry_polling = 0;
+    }
+}
+
+static const kernel_t kernels[] = {
+    { "compcurve",                 "call",   BENCH_CURVE_POINTS, setup_compressor, run_compcurve },
+    { "compressor_process",        "chunk",  1,                  setup_compressor, run_compressor_process },
+    { "compressor_set_params",     "call",   1,                  setup_compressor, run_compressor_set_params },
+    { "ringbuffer_power",          "sample", BENCH_CHUNK,        setup_ringbuffer, run_ringbuffer_power },
+    { "Gate_RunGate idle",         "sample", BENCH_CHUNK,        setup_gate_closed, run_gate },
+    { "Gate_RunGate attack",       "sample", BENCH_CHUNK,        setup_gate_attack, run_gate },
+    { "Gate_RunGate hold",         "sample", BENCH_CHUNK,        setup_gate_hold,   run_gate },
+    { "Gate_RunGate decay",        "sample", BENCH_CHUNK,        setup_gate_decay,  run_gate },
+    { "telemetry_publish",         "block",  1,                  setup_telemetry,   run_telemetry_publish },
+    { "telemetry_publish polled",  "block",  1,                  setup_telemetry_polled, run_telemetry_publish },
+};
+
+// --------------------------------------------------------------
+
+//writes through a buffer larger than the last level cache, so the next call starts from memory
+static void evict_caches(void)
+{
+    for (uint32_t i = 0; i < BENCH_EVICT_BYTES / sizeof(float); i += 16)
+        evict_buffer[i] += 1.0f;
+}
+
+static void print_result(const kernel_t *kernel, const char *cache, double elapsed, const counters_t *counters,
+                         double ops, int have_counters)
+{
+    printf("%-24s %-5s %-7s %10.3f", kernel->name, cache, kernel->unit, elapsed / ops);
+
+    if (!have_counters)
+    {
+        printf("\n");
+        return;
+    }
+
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (counters->fd[i] >= 0)
+            printf(" %11.2f", counters->value[i] / ops);
+        else
+            printf(" %11s", "-");
+    }
+
+    if (counters->fd[COUNTER_CYCLES] >= 0 && counters->fd[COUNTER_INSTRUCTIONS] >= 0 && counters->value[COUNTER_CYCLES])
+        printf(" %6.2f\n", (double)counters->value[COUNTER_INSTRUCTIONS] / counters->value[COUNTER_CYCLES]);
+    else
+        printf(" %6s\n", "-");
+}
+
+static void bench_kernel(const kernel_t *kernel, counters_t *counters, int have_counters)
+{
+    const uint32_t warm_runs = BENCH_WARM_OPS / kernel->ops;
+    double elapsed;
+
+    //warm: one untimed call, then a long run that stays in cache
+    kernel->setup();
+    kernel->run();
+    counters_clear(counters);
+
+    elapsed = now_ns();
+    counters_start(counters);
+    for (uint32_t r = 0; r < warm_runs; r++)
+        kernel->run();
+    counters_stop(counters);
+    elapsed = now_ns() - elapsed;
+
+    print_result(kernel, "warm", elapsed, counters, (double)warm_runs * kernel->ops, have_counters);
+
+    //cold: single calls after the data caches were flushed, summed over the runs
+    counters_clear(counters);
+    elapsed = 0.0;
+
+    for (uint32_t r = 0; r < BENCH_COLD_RUNS; r++)
+    {
+        kernel->setup();
+        evict_caches();
+
+        const double start = now_ns();
+        counters_start(counters);
+        kernel->run();
+        counters_stop(counters);
+        elapsed += now_ns() - start;
+    }
+
+    print_result(kernel, "cold", elapsed, counters, (double)BENCH_COLD_RUNS * kernel->ops, have_counters);
+}
+
+int main(void)
+{
+    counters_t counters;
+    uint32_t seed = 1;
+
+    evict_buffer = (float*)calloc(BENCH_EVICT_BYTES / sizeof(float), sizeof(float));
+    if (evict_buffer == NULL || !ringbuffer_init(&window, 128, NULL)
+        || !Gate_Init(&gate, BENCH_SAMPLE_RATE, GATE_DEFAULT_WINDOW_MS, 1, 1, NULL))
+        return 1;
+
+    //noise at -12 dBFS, loud enough to keep the compressor working
+    for (uint32_t i = 0; i < BENCH_CHUNK; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        chunk_l[i] = ((float)(seed >> 8) * (2.0f / 16777216.0f) - 1.0f) * 0.25f;
+        chunk_r[i] = -chunk_l[i] * 0.5f;
+    }
+
+    //from -80 dBFS to 0 dBFS, covers the linear, knee and compressed parts of the curve
+    for (uint32_t i = 0; i < BENCH_CURVE_POINTS; i++)
+        curve_points[i] = powf(10.0f, (-80.0f + 80.0f * i / (BENCH_CURVE_POINTS - 1)) / 20.0f);
+
+    const int have_counters = counters_open(&counters) > 0;
+    if (!have_counters)
+        printf("perf counters unavailable, clock timing only\n");
+
+    printf("%-24s %-5s %-7s %10s", "kernel", "cache", "per", "ns");
+    if (have_counters)
+        printf(" %11s %11s %11s %11s %6s", "cycles", "instr", "br-miss", "L1d-miss", "IPC");
+    printf("\n");
+
+    for (uint32_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+        bench_kernel(&kernels[k], &counters, have_counters);
+
+    if (telemetry_polling)
+    {
+        telemetry_polling = 0;
+        pthread_join(telemetry_reader, NULL);
+    }
+
+    counters_close(&counters);
+    Gate_Cleanup(&gate);
+    ringbuffer_free(&window);
+    free(evict_buffer);
+
+    return 0;
+}
@@ -0,0 +1,335 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#include "lv2-host.h"
+
+#include "lv2/lv2plug.in/ns/ext/atom/atom.h"
+#include "lv2/lv2plug.in/ns/ext/buf-size/buf-size.h"
+
+#define AUDIO_IN(i, s)          { i, HOST_PORT_AUDIO_IN, s, 0.0f, 0.0f, 0.0f }
+#define AUDIO_OUT(i, s)         { i, HOST_PORT_AUDIO_OUT, s, 0.0f, 0.0f, 0.0f }
+#define CV_OUT(i, s)            { i, HOST_PORT_CV_OUT, s, 0.0f, 0.0f, 10.0f }
+#define CONTROL_IN(i, s, d, l, h) { i, HOST_PORT_CONTROL_IN, s, d, l, h }
+#define CONTROL_OUT(i, s, l, h) { i, HOST_PORT_CONTROL_OUT, s, 0.0f, l, h }
+
+#define GATE_MULTI_PORTS(n) \
+    CONTROL_IN(2 * n, "Threshold", -60.0f, -70.0f, -10.0f), \
+    CONTROL_IN(2 * n + 1, "Decay", 10.0f, 1.0f, 500.0f)
+
+//port layout of the bundles in this repository, mirrors their ttl files
+const host_plugin_t host_plugins[] = {
+    {
+        "system-compressor",
+        "mod-compressor/system-compressor.lv2/system-compressor.so",
+        "http://moddevices.com/plugins/mod-devel/System-Compressor",
+        7, {
+            AUDIO_IN(0, "Input_L"), AUDIO_IN(1, "Input_R"),
+            AUDIO_OUT(2, "Output_L"), AUDIO_OUT(3, "Output_R"),
+            CONTROL_IN(4, "COMP_MODE", 1.0f, 1.0f, 3.0f),
+            CONTROL_IN(5, "RELEASE", 100.0f, 50.0f, 500.0f),
+            CONTROL_IN(6, "MASTER_VOL", 0.0f, -30.0f, 20.0f),
+        },
+        4, 3, { { 1.0f, "light" }, { 2.0f, "mild" }, { 3.0f, "heavy" } }
+    },
+    {
+        "advanced-compressor",
+        "mod-compressor-advanced/advanced-compressor.lv2/advanced-compressor.so",
+        "http://moddevices.com/plugins/mod-devel/Advanced-Compressor",
+        10, {
+            AUDIO_IN(0, "Input_L"), AUDIO_IN(1, "Input_R"),
+            AUDIO_OUT(2, "Output_L"), AUDIO_OUT(3, "Output_R"),
+            CONTROL_IN(4, "THRES", -20.0f, -70.0f, 0.0f),
+            CONTROL_IN(5, "KNEE", 20.0f, 0.0f, 40.0f),
+            CONTROL_IN(6, "ATTACK", 10.0f, 0.1f, 200.0f),
+            CONTROL_IN(7, "RELEASE", 100.0f, 1.0f, 1000.0f),
+            CONTROL_IN(8, "RATIO", 1.0f, 1.0f, 20.0f),
+            CONTROL_IN(9, "MAKEUP", 0.0f, -30.0f, 24.0f),
+        },
+        -1, 0, { { 0.0f, NULL } }
+    },
+    {
+        "system-noisegate",
+        "mod-noisegate/system-noisegate.lv2/system-noisegate.so",
+        "http://moddevices.com/plugins/mod-devel/System-NoiseGate",
+        9, {
+            AUDIO_IN(0, "Input_1"), AUDIO_IN(1, "Input_2"),
+            AUDIO_OUT(2, "Output_1"), AUDIO_OUT(3, "Output_2"),
+            CONTROL_IN(4, "Gate_Mode", 3.0f, 0.0f, 4.0f),
+            CONTROL_IN(5, "Threshold", -60.0f, -70.0f, -10.0f),
+            CONTROL_IN(6, "Decay", 10.0f, 1.0f, 500.0f),
+            CONTROL_IN(7, "Lookahead", 0.0f, 0.0f, 1.0f),
+            CONTROL_OUT(8, "latency", 0.0f, 4864.0f),
+        },
+        4, 4, { { 0.0f, "off" }, { 1.0f, "in1" }, { 2.0f, "in2" }, { 3.0f, "stereo" } }
+    },
+    {
+        "system-noisegate-4ch",
+        "mod-noisegate/system-noisegate-4ch.lv2/system-noisegate-4ch.so",
+        "http://moddevices.com/plugins/mod-devel/System-NoiseGate-4ch",
+        10, {
+            AUDIO_IN(0, "Input_1"), AUDIO_IN(1, "Input_2"), AUDIO_IN(2, "Input_3"), AUDIO_IN(3, "Input_4"),
+            AUDIO_OUT(4, "Output_1"), AUDIO_OUT(5, "Output_2"), AUDIO_OUT(6, "Output_3"), AUDIO_OUT(7, "Output_4"),
+            GATE_MULTI_PORTS(4),
+        },
+        -1, 0, { { 0.0f, NULL } }
+    },
+    {
+        "system-noisegate-8ch",
+        "mod-noisegate/system-noisegate-8ch.lv2/system-noisegate-8ch.so",
+        "http://moddevices.com/plugins/mod-devel/System-NoiseGate-8ch",
+        18, {
+            AUDIO_IN(0, "Input_1"), AUDIO_IN(1, "Input_2"), AUDIO_IN(2, "Input_3"), AUDIO_IN(3, "Input_4"),
+            AUDIO_IN(4, "Input_5"), AUDIO_IN(5, "Input_6"), AUDIO_IN(6, "Input_7"), AUDIO_IN(7, "Input_8"),
+            AUDIO_OUT(8, "Output_1"), AUDIO_OUT(9, "Output_2"), AUDIO_OUT(10, "Output_3"), AUDIO_OUT(11, "Output_4"),
+            AUDIO_OUT(12, "Output_5"), AUDIO_OUT(13, "Output_6"), AUDIO_OUT(14, "Output_7"), AUDIO_OUT(15, "Output_8"),
+            GATE_MULTI_PORTS(8),
+        },
+        -1, 0, { { 0.0f, NULL } }
+    },
+    {
+        "advanced-noisegate",
+        "mod-noisegate-advanced/advanced-noisegate.lv2/advanced-noisegate.so",
+        "http://moddevices.com/plugins/mod-devel/Advanced-NoiseGate",
+        12, {
+            AUDIO_IN(0, "Input"), AUDIO_IN(1, "Key"),
+            AUDIO_OUT(2, "Output"),
+            CONTROL_IN(3, "Threshold", -60.0f, -80.0f, -10.0f),
+            CONTROL_IN(4, "Attack", 10.0f, 1.0f, 100.0f),
+            CONTROL_IN(5, "Hold", 10.0f, 1.0f, 200.0f),
+            CONTROL_IN(6, "Decay", 10.0f, 1.0f, 1000.0f),
+            CV_OUT(7, "Cvoutput"),
+            CONTROL_IN(8, "Detector", 0.0f, 0.0f, 1.0f),
+            CONTROL_IN(9, "CV_Mode", 0.0f, 0.0f, 1.0f),
+            CONTROL_IN(10, "Lookahead", 0.0f, 0.0f, 1.0f),
+            CONTROL_OUT(11, "latency", 0.0f, 39424.0f),
+        },
+        8, 2, { { 0.0f, "average" }, { 1.0f, "peak" } }
+    },
+};
+
+const uint32_t host_plugin_count = sizeof(host_plugins) / sizeof(host_plugins[0]);
+
+//urid:map over a fixed table, the plugins only map a handful of uris at instantiate
+static const char *urids[HOST_MAX_URIDS];
+static uint32_t urid_count = 0;
+
+static LV2_URID host_map(LV2_URID_Map_Handle handle, const char *uri)
+{
+    (void)handle;
+
+    for (uint32_t i = 0; i < urid_count; i++)
+    {
+        if (strcmp(urids[i], uri) == 0)
+            return i + 1;
+    }
+
+    if (urid_count == HOST_MAX_URIDS)
+        return 0;
+
+    urids[urid_count] = strdup(uri);
+    return ++urid_count;
+}
+
+static LV2_URID_Map host_urid_map = { NULL, host_map };
+
+//hooks of the real-time safety checker, set when rt-check.so is preloaded
+static void (*host_rt_begin)(void);
+static void (*host_rt_end)(void);
+static uint32_t (*host_rt_count)(void);
+
+const host_plugin_t *host_find_plugin(const char *name)
+{
+    for (uint32_t i = 0; i < host_plugin_count; i++)
+    {
+        if (strcmp(host_plugins[i].name, name) == 0)
+            return &host_plugins[i];
+    }
+    return NULL;
+}
+
+//the plugins built into the mod-combined bundle
+static const char *const host_combined_plugins[] = {
+    "system-compressor",
+    "advanced-compressor",
+    "system-noisegate",
+    "advanced-noisegate",
+};
+
+static int host_load(host_instance_t *host, const host_plugin_t *plugin, const char *root, const char *binary,
+                     double sample_rate, uint32_t max_block)
+{
+    char path[4096];
+
+    memset(host, 0, sizeof(*host));
+    host->plugin = plugin;
+
+    snprintf(path, sizeof(path), "%s/%s", root, binary);
+
+    //present when rt-check.so is preloaded
+    if (!host_rt_count)
+    {
+        host_rt_begin = (void (*)(void))dlsym(RTLD_DEFAULT, "rt_check_run_begin");
+        host_rt_end = (void (*)(void))dlsym(RTLD_DEFAULT, "rt_check_run_end");
+        host_rt_count = (uint32_t (*)(void))dlsym(RTLD_DEFAULT, "rt_check_violations");
+    }
+
+    host->library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!host->library)
+    {
+        fprintf(stderr, "%s: %s\n", plugin->name, dlerror());
+        return 0;
+    }
+
+    const LV2_Descriptor *(*get_descriptor)(uint32_t) =
+        (const LV2_Descriptor *(*)(uint32_t))dlsym(host->library, "lv2_descriptor");
+
+    for (uint32_t i = 0; get_descriptor && (host->descriptor = get_descriptor(i)) != NULL; i++)
+    {
+        if (strcmp(host->descriptor->URI, plugin->uri) == 0)
+            break;
+    }
+
+    if (!host->descriptor)
+    {
+        fprintf(stderr, "%s: no descriptor for %s\n", plugin->name, plugin->uri);
+        host_close(host);
+        return 0;
+    }
+
+    const int32_t block_length = (int32_t)max_block;
+    const LV2_Options_Option options[] = {
+        { LV2_OPTIONS_INSTANCE, 0, host_map(NULL, LV2_BUF_SIZE__maxBlockLength),
+          sizeof(int32_t), host_map(NULL, LV2_ATOM__Int), &block_length },
+        { LV2_OPTIONS_INSTANCE, 0, host_map(NULL, LV2_BUF_SIZE__nominalBlockLength),
+          sizeof(int32_t), host_map(NULL, LV2_ATOM__Int), &block_length },
+        { LV2_OPTIONS_INSTANCE, 0, 0, 0, 0, NULL }
+    };
+    const LV2_Feature map_feature = { LV2_URID__map, &host_urid_map };
+    const LV2_Feature options_feature = { LV2_OPTIONS__options, (void *)options };
+    const LV2_Feature *features[] = { &map_feature, &options_feature, NULL };
+
+    host->handle = host->descriptor->instantiate(host->descriptor, sample_rate, "", features);
+    if (!host->handle)
+    {
+        fprintf(stderr, "%s: instantiate failed\n", plugin->name);
+        host_close(host);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < plugin->n_ports; i++)
+    {
+        const host_port_t *port = &plugin->ports[i];
+
+        switch (port->type)
+        {
+            case HOST_PORT_AUDIO_IN:
+                break;
+            case HOST_PORT_AUDIO_OUT:
+            case HOST_PORT_CV_OUT:
+                host->buffers[port->index] = (float *)calloc(max_block, sizeof(float));
+                host->descriptor->connect_port(host->handle, port->index, host->buffers[port->index]);
+                break;
+            case HOST_PORT_CONTROL_IN:
+            case HOST_PORT_CONTROL_OUT:
+                host->descriptor->connect_port(host->handle, port->index, &host->controls[port->index]);
+                break;
+        }
+    }
+
+    host_reset_controls(host);
+
+    if (host->descriptor->activate)
+        host->descriptor->activate(host->handle);
+
+    return 1;
+}
+
+int host_open(host_instance_t *host, const host_plugin_t *plugin, const char *root, double sample_rate, uint32_t max_block)
+{
+    return host_load(host, plugin, root, plugin->binary, sample_rate, max_block);
+}
+
+int host_open_combined(host_instance_t *host, const host_plugin_t *plugin, const char *root, double sample_rate, uint32_t max_block)
+{
+    for (uint32_t i = 0; i < sizeof(host_combined_plugins) / sizeof(host_combined_plugins[0]); i++)
+    {
+        if (strcmp(host_combined_plugins[i], plugin->name) == 0)
+            return host_load(host, plugin, root, HOST_COMBINED_BINARY, sample_rate, max_block);
+    }
+    return host_load(host, plugin, root, plugin->binary, sample_rate, max_block);
+}
+
+void host_close(host_instance_t *host)
+{
+    if (host->handle)
+    {
+        if (host->descriptor->deactivate)
+            host->descriptor->deactivate(host->handle);
+        host->descriptor->cleanup(host->handle);
+    }
+
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++)
+        free(host->buffers[i]);
+
+    if (host->library)
+        dlclose(host->library);
+
+    memset(host, 0, sizeof(*host));
+}
+
+void host_reset_controls(host_instance_t *host)
+{
+    for (uint32_t i = 0; i < host->plugin->n_ports; i++)
+        host->controls[host->plugin->ports[i].index] = host->plugin->ports[i].def;
+}
+
+void host_set_control(host_instance_t *host, uint32_t index, float value)
+{
+    host->controls[index] = value;
+}
+
+void host_set_mode(host_instance_t *host, uint32_t mode)
+{
+    if (host->plugin->mode_port >= 0 && mode < host->plugin->n_modes)
+        host->controls[host->plugin->mode_port] = host->plugin->modes[mode].value;
+}
+
+void host_run(host_instance_t *host, const float *input, uint32_t n)
+{
+    for (uint32_t i = 0; i < host->plugin->n_ports; i++)
+    {
+        if (host->plugin->ports[i].type == HOST_PORT_AUDIO_IN)
+            host->descriptor->connect_port(host->handle, host->plugin->ports[i].index, (void *)input);
+    }
+
+    if (host_rt_begin)
+        host_rt_begin();
+
+    host->descriptor->run(host->handle, n);
+
+    if (host_rt_end)
+        host_rt_end();
+}
+
+uint32_t host_rt_violations(void)
+{
+    return host_rt_count ? host_rt_count() : 0;
+}
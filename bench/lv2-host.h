@@ -0,0 +1,101 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// minimal LV2 host stand-in, just enough of the host side to load and run the system plugins
+
+#ifndef LV2_HOST_H_INCLUDED
+#define LV2_HOST_H_INCLUDED
+
+#include <stdint.h>
+
+#include "lv2/lv2plug.in/ns/lv2core/lv2.h"
+#include "lv2/lv2plug.in/ns/ext/urid/urid.h"
+#include "lv2/lv2plug.in/ns/ext/options/options.h"
+
+#define HOST_MAX_PORTS 24
+#define HOST_MAX_MODES 8
+#define HOST_MAX_URIDS 64
+#define HOST_MAX_BLOCK 4096
+
+//relative to the repository root
+#define HOST_COMBINED_BINARY "mod-combined/mod-system-plugins.lv2/mod-system-plugins.so"
+
+typedef enum {
+    HOST_PORT_AUDIO_IN,
+    HOST_PORT_AUDIO_OUT,
+    HOST_PORT_CV_OUT,
+    HOST_PORT_CONTROL_IN,
+    HOST_PORT_CONTROL_OUT
+} host_port_type_t;
+
+typedef struct {
+    uint32_t index;
+    host_port_type_t type;
+    const char *symbol;
+    float def;
+    float min;
+    float max;
+} host_port_t;
+
+typedef struct {
+    float value;
+    const char *label;
+} host_mode_t;
+
+typedef struct {
+    const char *name;
+    const char *binary;     //relative to the repository root
+    const char *uri;
+    uint32_t n_ports;
+    host_port_t ports[HOST_MAX_PORTS];
+    //enumeration port swept as the plugin "mode", -1 for plugins without one
+    int32_t mode_port;
+    uint32_t n_modes;
+    host_mode_t modes[HOST_MAX_MODES];
+} host_plugin_t;
+
+typedef struct {
+    const host_plugin_t *plugin;
+    void *library;
+    const LV2_Descriptor *descriptor;
+    LV2_Handle handle;
+    float controls[HOST_MAX_PORTS];
+    float *buffers[HOST_MAX_PORTS];
+} host_instance_t;
+
+extern const host_plugin_t host_plugins[];
+extern const uint32_t host_plugin_count;
+
+const host_plugin_t *host_find_plugin(const char *name);
+
+//loads the plugin binary below root and instantiates it, returns 1 on success
+int host_open(host_instance_t *host, const host_plugin_t *plugin, const char *root, double sample_rate, uint32_t max_block);
+//same as host_open, but loads the plugin from the combined bundle when it is part of it
+int host_open_combined(host_instance_t *host, const host_plugin_t *plugin, const char *root, double sample_rate, uint32_t max_block);
+void host_close(host_instance_t *host);
+
+//control ports start at their default, modes index into plugin->modes
+void host_reset_controls(host_instance_t *host);
+void host_set_control(host_instance_t *host, uint32_t index, float value);
+void host_set_mode(host_instance_t *host, uint32_t mode);
+
+//connects every audio input to input and calls run(), n must not exceed max_block
+void host_run(host_instance_t *host, const float *input, uint32_t n);
+
+//calls made inside run() that are not real-time safe, 0 unless the host runs with rt-check.so preloaded
+uint32_t host_rt_violations(void);
+
+#endif //LV2_HOST_H_INCLUDED
@@ -0,0 +1,665 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// cost of every plugin across its parameter space, to find the settings that fall off a cliff
+// the control ranges are read from the ttl of each bundle, every pair of controls is swept over a
+// grid with the others at their default, on every corpus signal, and printed as a heat map of
+// cycles per sample (ns per sample where the kernel does not give us the cycle counter)
+// with -c the worst cell of every map is compared against an earlier result file
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <fenv.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "lv2-host.h"
+#include "corpus.h"
+
+#define SWEEP_SAMPLE_RATE 48000
+#define SWEEP_MAX_POINTS 16
+#define SWEEP_MAX_DEPTH 8
+#define SWEEP_MAX_RESULTS 256
+
+//from cold to hot, a cell is shaded by where it falls between the cheapest and the dearest of its map
+static const char sweep_shades[] = " .:-=+*#%@";
+
+typedef struct {
+    int32_t index;
+    int has_def, has_min, has_max;
+    float def, min, max;
+    int toggled, enumeration, integer;
+    uint32_t n_points;
+    float points[SWEEP_MAX_POINTS];
+} ttl_port_t;
+
+typedef struct {
+    uint32_t port;
+    const char *symbol;
+    float def;
+    uint32_t n_points;
+    float points[SWEEP_MAX_POINTS];
+} sweep_axis_t;
+
+typedef struct {
+    const char *root;
+    const char *only;
+    const char *x;
+    const char *y;
+    double seconds;
+    uint32_t repetitions;
+    uint32_t grid;
+    uint32_t block_size;
+} sweep_options_t;
+
+typedef struct {
+    char plugin[64];
+    char x[32];
+    char y[32];
+    double def;
+    double worst;
+} sweep_result_t;
+
+static int cycle_counter = -1;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// --------------------------------------------------------------
+// cost of a pass, in cycles of this thread when perf_event_open lets us count them
+
+static void cycles_open(void)
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    cycle_counter = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static const char *cost_unit(void)
+{
+    return cycle_counter >= 0 ? "cycles" : "ns";
+}
+
+static void cost_start(double *start)
+{
+#ifdef __linux__
+    if (cycle_counter >= 0)
+    {
+        ioctl(cycle_counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(cycle_counter, PERF_EVENT_IOC_ENABLE, 0);
+        return;
+    }
+#endif
+    *start = now_ns();
+}
+
+static double cost_stop(double start)
+{
+#ifdef __linux__
+    uint64_t value;
+
+    if (cycle_counter >= 0)
+    {
+        ioctl(cycle_counter, PERF_EVENT_IOC_DISABLE, 0);
+        return read(cycle_counter, &value, sizeof(value)) == sizeof(value) ? (double)value : 0.0;
+    }
+#endif
+    return now_ns() - start;
+}
+
+// --------------------------------------------------------------
+// just enough turtle for the port descriptions of this repository: every [ ] block is a record,
+// a record with an lv2:index is a port, one with an rdf:value is a scale point of its parent
+
+static int ttl_keyword(const char *p, const char *keyword, const char **value)
+{
+    const size_t length = strlen(keyword);
+
+    if (strncmp(p, keyword, length) != 0 || (p[length] != ' ' && p[length] != '\t' && p[length] != '\n'
+                                             && p[length] != ';' && p[length] != ',' && p[length] != ']'))
+        return 0;
+
+    *value = p + length;
+    return 1;
+}
+
+static void ttl_close(ttl_port_t *stack, int depth, ttl_port_t *ports)
+{
+    const ttl_port_t *record = &stack[depth];
+
+    if (record->index >= 0 && record->index < HOST_MAX_PORTS)
+        ports[record->index] = *record;
+    else if (record->n_points == 1 && depth > 0 && stack[depth - 1].n_points < SWEEP_MAX_POINTS)
+        stack[depth - 1].points[stack[depth - 1].n_points++] = record->points[0];
+}
+
+//fills ports by lv2:index, returns the number of ports found
+static uint32_t ttl_read(const char *path, ttl_port_t *ports)
+{
+    ttl_port_t stack[SWEEP_MAX_DEPTH];
+    uint32_t found = 0;
+    int depth = 0;
+    FILE *file = fopen(path, "r");
+
+    if (!file)
+    {
+        perror(path);
+        return 0;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = size > 0 ? (char *)malloc((size_t)size + 1) : NULL;
+    if (!text || fread(text, 1, (size_t)size, file) != (size_t)size)
+    {
+        fprintf(stderr, "%s: could not be read\n", path);
+        fclose(file);
+        free(text);
+        return 0;
+    }
+    text[size] = '\0';
+    fclose(file);
+
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++)
+        ports[i].index = -1;
+    memset(&stack[0], 0, sizeof(stack[0]));
+    stack[0].index = -1;
+
+    for (const char *p = text; *p; p++)
+    {
+        ttl_port_t *record = &stack[depth];
+        const char *value;
+
+        //iris and strings may hold any of the characters below
+        if (*p == '<' || *p == '"')
+        {
+            const char end = *p == '<' ? '>' : '"';
+            while (p[1] && p[1] != end)
+                p++;
+            if (p[1])
+                p++;
+        }
+        else if (*p == '#')
+        {
+            while (p[1] && p[1] != '\n')
+                p++;
+        }
+        else if (*p == '[' && depth + 1 < SWEEP_MAX_DEPTH)
+        {
+            depth++;
+            memset(&stack[depth], 0, sizeof(stack[depth]));
+            stack[depth].index = -1;
+        }
+        else if (*p == ']' && depth > 0)
+        {
+            if (record->index >= 0)
+                found++;
+            ttl_close(stack, depth, ports);
+            depth--;
+        }
+        else if (ttl_keyword(p, "lv2:index", &value))
+            record->index = (int32_t)strtol(value, NULL, 10);
+        else if (ttl_keyword(p, "lv2:default", &value))
+            record->def = strtof(value, NULL), record->has_def = 1;
+        else if (ttl_keyword(p, "lv2:minimum", &value))
+            record->min = strtof(value, NULL), record->has_min = 1;
+        else if (ttl_keyword(p, "lv2:maximum", &value))
+            record->max = strtof(value, NULL), record->has_max = 1;
+        else if (ttl_keyword(p, "lv2:toggled", &value))
+            record->toggled = 1;
+        else if (ttl_keyword(p, "lv2:enumeration", &value))
+            record->enumeration = 1;
+        else if (ttl_keyword(p, "lv2:integer", &value))
+            record->integer = 1;
+        else if (ttl_keyword(p, "rdf:value", &value) && record->n_points == 0)
+            record->points[record->n_points++] = strtof(value, NULL);
+    }
+
+    free(text);
+    return found;
+}
+
+//the ttl sits next to the binary of every bundle and carries its name
+static int sweep_axes(const sweep_options_t *opts, const host_plugin_t *plugin, sweep_axis_t *axes, uint32_t *n_axes)
+{
+    ttl_port_t ports[HOST_MAX_PORTS];
+    char path[1024];
+    const size_t length = strlen(plugin->binary);
+
+    if (length < 3 || snprintf(path, sizeof(path), "%s/%.*s.ttl", opts->root, (int)(length - 3), plugin->binary) >= (int)sizeof(path)
+        || !ttl_read(path, ports))
+        return 0;
+
+    *n_axes = 0;
+
+    for (uint32_t i = 0; i < plugin->n_ports; i++)
+    {
+        const host_port_t *port = &plugin->ports[i];
+        const ttl_port_t *ttl = &ports[port->index];
+        sweep_axis_t *axis = &axes[*n_axes];
+
+        if (port->type != HOST_PORT_CONTROL_IN)
+            continue;
+
+        if (ttl->index < 0 || !ttl->has_def || !ttl->has_min || !ttl->has_max || ttl->max < ttl->min)
+        {
+            fprintf(stderr, "%s: port %u has no usable range\n", path, port->index);
+            return 0;
+        }
+
+        if (ttl->def != port->def || ttl->min != port->min || ttl->max != port->max)
+            fprintf(stderr, "%s: %s is %g [%g, %g] in the ttl but %g [%g, %g] in lv2-host.c, sweeping the ttl range\n",
+                    plugin->name, port->symbol, ttl->def, ttl->min, ttl->max, port->def, port->min, port->max);
+
+        axis->port = port->index;
+        axis->symbol = port->symbol;
+        axis->def = ttl->def;
+
+        if (ttl->enumeration && ttl->n_points > 0)
+        {
+            axis->n_points = ttl->n_points;
+            memcpy(axis->points, ttl->points, ttl->n_points * sizeof(float));
+        }
+        else if (ttl->toggled)
+        {
+            axis->n_points = 2;
+            axis->points[0] = ttl->min;
+            axis->points[1] = ttl->max;
+        }
+        else if (ttl->integer && ttl->max - ttl->min + 1.0f <= (float)opts->grid)
+        {
+            axis->n_points = (uint32_t)(ttl->max - ttl->min) + 1;
+            for (uint32_t p = 0; p < axis->n_points; p++)
+                axis->points[p] = ttl->min + p;
+        }
+        else
+        {
+            axis->n_points = opts->grid;
+            for (uint32_t p = 0; p < axis->n_points; p++)
+                axis->points[p] = ttl->min + (ttl->max - ttl->min) * p / (opts->grid - 1);
+        }
+
+        (*n_axes)++;
+    }
+
+    return 1;
+}
+
+// --------------------------------------------------------------
+
+//settles the plugin on the signal once, then keeps the cheapest of the timed passes, per sample
+static double sweep_signal(host_instance_t *host, const sweep_options_t *opts, const float *signal, uint32_t length)
+{
+    double best = 0.0;
+
+    for (uint32_t r = 0; r <= opts->repetitions; r++)
+    {
+        double start = 0.0;
+
+        cost_start(&start);
+        for (uint32_t pos = 0; pos < length; pos += opts->block_size)
+        {
+            const uint32_t n = length - pos < opts->block_size ? length - pos : opts->block_size;
+            host_run(host, signal + pos, n);
+        }
+        const double cost = cost_stop(start);
+
+        if (r == 1 || (r > 1 && cost < best))
+            best = cost;
+    }
+
+    return best / length;
+}
+
+static void sweep_set(host_instance_t *host, const sweep_axis_t *axes, uint32_t n_axes)
+{
+    for (uint32_t a = 0; a < n_axes; a++)
+        host_set_control(host, axes[a].port, axes[a].def);
+}
+
+//worst signal of a cell
+static double sweep_worst(const double *costs, int *signal)
+{
+    int worst = 0;
+
+    for (int s = 1; s < CORPUS_COUNT; s++)
+    {
+        if (costs[s] > costs[worst])
+            worst = s;
+    }
+
+    if (signal)
+        *signal = worst;
+    return costs[worst];
+}
+
+static void print_map(const host_plugin_t *plugin, const sweep_axis_t *x, const sweep_axis_t *y,
+                      double cells[SWEEP_MAX_POINTS][SWEEP_MAX_POINTS][CORPUS_COUNT], double def)
+{
+    double low = INFINITY, high = 0.0;
+    uint32_t worst_x = 0, worst_y = 0;
+    int worst_signal = 0;
+
+    for (uint32_t j = 0; j < y->n_points; j++)
+    {
+        for (uint32_t i = 0; i < x->n_points; i++)
+        {
+            int signal;
+            const double cost = sweep_worst(cells[j][i], &signal);
+
+            if (cost < low)
+                low = cost;
+            if (cost > high)
+            {
+                high = cost;
+                worst_x = i, worst_y = j, worst_signal = signal;
+            }
+        }
+    }
+
+    printf("\n%s: %s across, %s down, %s/sample on the dearest signal\n%10s", plugin->name, x->symbol, y->symbol,
+           cost_unit(), "");
+    for (uint32_t i = 0; i < x->n_points; i++)
+        printf(" %8.4g", x->points[i]);
+    printf("\n");
+
+    for (uint32_t j = 0; j < y->n_points; j++)
+    {
+        printf("%10.4g", y->points[j]);
+
+        for (uint32_t i = 0; i < x->n_points; i++)
+        {
+            const double cost = sweep_worst(cells[j][i], NULL);
+            const int shade = high > low ? (int)((cost - low) / (high - low) * (sizeof(sweep_shades) - 2) + 0.5) : 0;
+            printf(" %7.1f%c", cost, sweep_shades[shade]);
+        }
+        printf("\n");
+    }
+
+    printf("worst %.1f at %s=%g %s=%g on %s, %.2fx the defaults\n", high, x->symbol, x->points[worst_x],
+           y->symbol, y->points[worst_y], corpus_names[worst_signal], high / def);
+}
+
+static void write_map(FILE *out, const host_plugin_t *plugin, const sweep_axis_t *x, const sweep_axis_t *y,
+                      double cells[SWEEP_MAX_POINTS][SWEEP_MAX_POINTS][CORPUS_COUNT], double def, int *first)
+{
+    double worst = 0.0;
+
+    for (uint32_t j = 0; j < y->n_points; j++)
+    {
+        for (uint32_t i = 0; i < x->n_points; i++)
+        {
+            const double cost = sweep_worst(cells[j][i], NULL);
+            worst = cost > worst ? cost : worst;
+        }
+    }
+
+    fprintf(out, "%s\n    {\"plugin\": \"%s\", \"x\": \"%s\", \"y\": \"%s\", \"default\": %.3f, \"worst\": %.3f, \"x_values\": [",
+            *first ? "" : ",", plugin->name, x->symbol, y->symbol, def, worst);
+    for (uint32_t i = 0; i < x->n_points; i++)
+        fprintf(out, "%s%g", i ? ", " : "", x->points[i]);
+    fprintf(out, "], \"y_values\": [");
+    for (uint32_t j = 0; j < y->n_points; j++)
+        fprintf(out, "%s%g", j ? ", " : "", y->points[j]);
+    fprintf(out, "], \"signals\": {");
+
+    //rows follow y_values, columns x_values
+    for (int s = 0; s < CORPUS_COUNT; s++)
+    {
+        fprintf(out, "%s\"%s\": [", s ? ", " : "", corpus_names[s]);
+        for (uint32_t j = 0; j < y->n_points; j++)
+        {
+            fprintf(out, "%s[", j ? ", " : "");
+            for (uint32_t i = 0; i < x->n_points; i++)
+                fprintf(out, "%s%.3f", i ? ", " : "", cells[j][i][s]);
+            fprintf(out, "]");
+        }
+        fprintf(out, "]");
+    }
+
+    fprintf(out, "}}");
+    fflush(out);
+    *first = 0;
+}
+
+static int sweep_plugin(FILE *out, const sweep_options_t *opts, const corpus_t *corpus,
+                        const host_plugin_t *plugin, int *first)
+{
+    static double cells[SWEEP_MAX_POINTS][SWEEP_MAX_POINTS][CORPUS_COUNT];
+    sweep_axis_t axes[HOST_MAX_PORTS];
+    double defaults[CORPUS_COUNT];
+    uint32_t n_axes;
+    host_instance_t host;
+
+    if (!sweep_axes(opts, plugin, axes, &n_axes))
+        return 0;
+
+    if (!host_open(&host, plugin, opts->root, SWEEP_SAMPLE_RATE, opts->block_size))
+        return 0;
+
+    sweep_set(&host, axes, n_axes);
+    for (int s = 0; s < CORPUS_COUNT; s++)
+        defaults[s] = sweep_signal(&host, opts, corpus->signals[s], corpus->length);
+    const double def = sweep_worst(defaults, NULL);
+
+    for (uint32_t a = 0; a < n_axes; a++)
+    {
+        for (uint32_t b = a + 1; b < n_axes; b++)
+        {
+            const sweep_axis_t *x = &axes[a], *y = &axes[b];
+
+            if ((opts->x && strcmp(opts->x, x->symbol) != 0 && strcmp(opts->x, y->symbol) != 0)
+                || (opts->y && strcmp(opts->y, x->symbol) != 0 && strcmp(opts->y, y->symbol) != 0))
+                continue;
+
+            //a named control goes across
+            if (opts->x && strcmp(opts->x, y->symbol) == 0)
+                x = &axes[b], y = &axes[a];
+
+            for (uint32_t j = 0; j < y->n_points; j++)
+            {
+                for (uint32_t i = 0; i < x->n_points; i++)
+                {
+                    sweep_set(&host, axes, n_axes);
+                    host_set_control(&host, x->port, x->points[i]);
+                    host_set_control(&host, y->port, y->points[j]);
+
+                    for (int s = 0; s < CORPUS_COUNT; s++)
+                        cells[j][i][s] = sweep_signal(&host, opts, corpus->signals[s], corpus->length);
+                }
+            }
+
+            print_map(plugin, x, y, cells, def);
+            write_map(out, plugin, x, y, cells, def, first);
+        }
+    }
+
+    host_close(&host);
+    return 1;
+}
+
+// --------------------------------------------------------------
+
+//reads back the map summaries of a file written by this tool, one map per line
+static uint32_t read_results(const char *path, sweep_result_t *results)
+{
+    static char line[1 << 16];
+    uint32_t count = 0;
+    FILE *file = fopen(path, "r");
+
+    if (!file)
+    {
+        perror(path);
+        return 0;
+    }
+
+    while (count < SWEEP_MAX_RESULTS && fgets(line, sizeof(line), file))
+    {
+        sweep_result_t *r = &results[count];
+
+        if (sscanf(line, " {\"plugin\": \"%63[^\"]\", \"x\": \"%31[^\"]\", \"y\": \"%31[^\"]\", \"default\": %lf, \"worst\": %lf",
+                   r->plugin, r->x, r->y, &r->def, &r->worst) == 5)
+            count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+//a cliff is the worst cell of a map against the defaults, an optimization that only helps the
+//average lowers both, one that removes the cliff brings the ratio down
+static int compare_results(const char *baseline_path, const char *current_path)
+{
+    static sweep_result_t baseline[SWEEP_MAX_RESULTS], current[SWEEP_MAX_RESULTS];
+    const uint32_t n_baseline = read_results(baseline_path, baseline);
+    const uint32_t n_current = read_results(current_path, current);
+
+    if (!n_baseline || !n_current)
+        return 0;
+
+    printf("\n%-24s %-24s %10s %10s %9s %9s\n", "plugin", "map", "worst was", "worst now", "cliff was", "cliff now");
+
+    for (uint32_t c = 0; c < n_current; c++)
+    {
+        for (uint32_t b = 0; b < n_baseline; b++)
+        {
+            char map[64];
+
+            if (strcmp(baseline[b].plugin, current[c].plugin) != 0 || strcmp(baseline[b].x, current[c].x) != 0
+                || strcmp(baseline[b].y, current[c].y) != 0)
+                continue;
+
+            snprintf(map, sizeof(map), "%s/%s", current[c].x, current[c].y);
+            printf("%-24s %-24s %10.1f %10.1f %8.2fx %8.2fx\n", current[c].plugin, map, baseline[b].worst,
+                   current[c].worst, baseline[b].worst / baseline[b].def, current[c].worst / current[c].def);
+            break;
+        }
+    }
+
+    return 1;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-r repo-root] [-p plugin] [-x control] [-y control] [-g grid-points] [-b block-size]\n"
+                    "       [-s seconds] [-n repetitions] [-o output.json [-c baseline.json]]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    sweep_options_t opts = { "..", NULL, NULL, NULL, 0.5, 3, 7, 128 };
+    const char *output = "param-sweep.json", *baseline = NULL;
+    corpus_t corpus;
+    int opt, first = 1, failed = 0;
+
+    while ((opt = getopt(argc, argv, "r:p:x:y:g:b:s:n:o:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': opts.root = optarg; break;
+            case 'p': opts.only = optarg; break;
+            case 'x': opts.x = optarg; break;
+            case 'y': opts.y = optarg; break;
+            case 'g': opts.grid = (uint32_t)atoi(optarg); break;
+            case 'b': opts.block_size = (uint32_t)atoi(optarg); break;
+            case 's': opts.seconds = atof(optarg); break;
+            case 'n': opts.repetitions = (uint32_t)atoi(optarg); break;
+            case 'o': output = optarg; break;
+            case 'c': baseline = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (opts.seconds <= 0.0 || opts.repetitions == 0 || opts.grid < 2 || opts.grid > SWEEP_MAX_POINTS
+        || opts.block_size == 0 || opts.block_size > HOST_MAX_BLOCK)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.only && !host_find_plugin(opts.only))
+    {
+        fprintf(stderr, "unknown plugin %s\n", opts.only);
+        return 1;
+    }
+
+    //same floating point environment as plugin-bench, the plugins set their own in run()
+    fesetenv(FE_DFL_ENV);
+
+    if (!corpus_init(&corpus, SWEEP_SAMPLE_RATE, (uint32_t)(opts.seconds * SWEEP_SAMPLE_RATE)))
+        return 1;
+
+    FILE *out = fopen(output, "w");
+    if (!out)
+    {
+        perror(output);
+        corpus_free(&corpus);
+        return 1;
+    }
+
+    cycles_open();
+    if (cycle_counter < 0)
+        printf("perf counters unavailable, clock timing only\n");
+
+    fprintf(out, "{\n  \"benchmark\": \"parameter-sweep\",\n  \"sample_rate\": %u,\n  \"signal_seconds\": %.3f,\n"
+                 "  \"repetitions\": %u,\n  \"block_size\": %u,\n  \"unit\": \"%s_per_sample\",\n  \"results\": [",
+            SWEEP_SAMPLE_RATE, opts.seconds, opts.repetitions, opts.block_size, cost_unit());
+
+    for (uint32_t p = 0; p < host_plugin_count; p++)
+    {
+        if (opts.only && strcmp(opts.only, host_plugins[p].name) != 0)
+            continue;
+
+        failed |= !sweep_plugin(out, &opts, &corpus, &host_plugins[p], &first);
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    fclose(out);
+    corpus_free(&corpus);
+
+    if (cycle_counter >= 0)
+        close(cycle_counter);
+
+    if (baseline && !failed)
+        failed = !compare_results(baseline, output);
+
+    return failed;
+}
@@ -0,0 +1,514 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+// throughput of every plugin binary through the host stand-in, per mode and block size, as json
+// with -j every run() call is timed instead, under scripted parameter automation, to catch spikes
+// with -c the throughput is compared against an earlier result file, e.g. the build before PGO
+// with -t a noise tail decays through the denormal range into silence, timed per level band
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <fenv.h>
+
+#include "lv2-host.h"
+#include "corpus.h"
+#include "dsp_telemetry.h"
+
+#define BENCH_SAMPLE_RATE 48000
+#define BENCH_MIN_BLOCK 16
+#define BENCH_MAX_BLOCK 4096
+
+//automation script of the jitter mode, in blocks
+#define JITTER_MODE_FLIP 50
+#define JITTER_SWEEP_BASE 200
+#define JITTER_HISTOGRAM_BINS 16
+
+//the tail falls linearly in dB from 0 dBFS to below the smallest denormal (-897 dBFS),
+//floats turn denormal below -758 dBFS, so the last two bands hold the denormal and zero samples
+#define TAIL_FLOOR_DB -900.0
+#define TAIL_BANDS 8
+#define TAIL_BLOCK 64
+
+#define COMPARE_MAX_RESULTS 1024
+
+typedef struct {
+    char plugin[64];
+    char mode[32];
+    uint32_t block_size;
+    double ns_per_sample;
+} bench_result_t;
+
+typedef struct {
+    const char *root;
+    const char *only;
+    double seconds;
+    uint32_t repetitions;
+    int jitter;
+    int tail;
+    int combined;
+    uint32_t block_size;
+} bench_options_t;
+
+static int bench_open(host_instance_t *host, const bench_options_t *opts, const host_plugin_t *plugin)
+{
+    return opts->combined ? host_open_combined(host, plugin, opts->root, BENCH_SAMPLE_RATE, BENCH_MAX_BLOCK)
+                          : host_open(host, plugin, opts->root, BENCH_SAMPLE_RATE, BENCH_MAX_BLOCK);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+//one pass over a signal in blocks of block_size, returns the elapsed time
+static double run_signal(host_instance_t *host, const float *signal, uint32_t length, uint32_t block_size)
+{
+    const double start = now_ns();
+
+    for (uint32_t pos = 0; pos < length; pos += block_size)
+    {
+        const uint32_t n = length - pos < block_size ? length - pos : block_size;
+        host_run(host, signal + pos, n);
+    }
+
+    return now_ns() - start;
+}
+
+static int bench_mode(FILE *out, const bench_options_t *opts, const corpus_t *corpus,
+                      const host_plugin_t *plugin, uint32_t mode, uint32_t block_size, int *first)
+{
+    host_instance_t host;
+    double best[CORPUS_COUNT];
+    double total = 0.0;
+
+    if (!bench_open(&host, opts, plugin))
+        return 0;
+
+    host_set_mode(&host, mode);
+
+    for (int s = 0; s < CORPUS_COUNT; s++)
+    {
+        //the first pass settles the envelopes and faults in the buffers
+        run_signal(&host, corpus->signals[s], corpus->length, block_size);
+
+        best[s] = 0.0;
+        for (uint32_t r = 0; r < opts->repetitions; r++)
+        {
+            const double elapsed = run_signal(&host, corpus->signals[s], corpus->length, block_size);
+            if (r == 0 || elapsed < best[s])
+                best[s] = elapsed;
+        }
+        total += best[s];
+    }
+
+    host_close(&host);
+
+    const double ns_per_sample = total / ((double)corpus->length * CORPUS_COUNT);
+
+    fprintf(out, "%s\n    {\"plugin\": \"%s\", \"mode\": \"%s\", \"block_size\": %u, "
+                 "\"ns_per_sample\": %.3f, \"samples_per_second\": %.0f, \"signals\": {",
+            *first ? "" : ",", plugin->name, plugin->n_modes ? plugin->modes[mode].label : "default",
+            block_size, ns_per_sample, 1e9 / ns_per_sample);
+
+    for (int s = 0; s < CORPUS_COUNT; s++)
+        fprintf(out, "%s\"%s\": %.3f", s ? ", " : "", corpus_names[s], best[s] / corpus->length);
+
+    fprintf(out, "}}");
+    fflush(out);
+    *first = 0;
+
+    return 1;
+}
+
+//moves every control input along its own triangle between minimum and maximum and cycles the modes,
+//so the run includes parameter recalculation, mode switches and threshold crossings in both directions
+static void jitter_automate(host_instance_t *host, uint32_t block)
+{
+    const host_plugin_t *plugin = host->plugin;
+
+    for (uint32_t i = 0; i < plugin->n_ports; i++)
+    {
+        const host_port_t *port = &plugin->ports[i];
+
+        if (port->type != HOST_PORT_CONTROL_IN || (int32_t)port->index == plugin->mode_port)
+            continue;
+
+        const uint32_t period = JITTER_SWEEP_BASE + 37 * i;
+        const uint32_t phase = block % (2 * period);
+        const float position = (float)(phase < period ? phase : 2 * period - phase) / period;
+
+        host_set_control(host, port->index, port->min + (port->max - port->min) * position);
+    }
+
+    if (plugin->n_modes)
+        host_set_mode(host, (block / JITTER_MODE_FLIP) % plugin->n_modes);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, uint32_t count, double p)
+{
+    const uint32_t index = (uint32_t)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+static int bench_jitter(FILE *out, const bench_options_t *opts, const corpus_t *corpus,
+                        const host_plugin_t *plugin, int *first)
+{
+    const uint32_t block_size = opts->block_size;
+    const uint32_t blocks_per_signal = corpus->length / block_size;
+    const uint32_t runs = blocks_per_signal * CORPUS_COUNT * opts->repetitions;
+    const double budget_us = 1e6 * block_size / BENCH_SAMPLE_RATE;
+    uint32_t histogram[JITTER_HISTOGRAM_BINS] = { 0 };
+    uint32_t worst_run = 0;
+    host_instance_t host;
+
+    if (runs == 0)
+        return 0;
+
+    double *times = (double *)malloc(runs * sizeof(double));
+    if (!times)
+        return 0;
+
+    if (!bench_open(&host, opts, plugin))
+    {
+        free(times);
+        return 0;
+    }
+
+    //no warm up pass, the first blocks after instantiate are part of the worst case
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        const uint32_t signal = (run / blocks_per_signal) % CORPUS_COUNT;
+        const float *input = corpus->signals[signal] + (run % blocks_per_signal) * block_size;
+
+        jitter_automate(&host, run);
+
+        const double start = now_ns();
+        host_run(&host, input, block_size);
+        times[run] = (now_ns() - start) * 1e-3;
+
+        if (times[run] > times[worst_run])
+            worst_run = run;
+    }
+
+    //what the plugin saw of the run, read the way a UI would
+    dsp_telemetry_values_t telemetry;
+    const dsp_telemetry_interface_t *reader =
+        (const dsp_telemetry_interface_t *)host.descriptor->extension_data(DSP_TELEMETRY__interface);
+    const int have_telemetry = reader && reader->read(host.handle, &telemetry, 0);
+
+    host_close(&host);
+
+    //log2 bins in microseconds, the first bin holds everything below 1 us, the last everything above
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        uint32_t bin = 0;
+        for (double edge = 1.0; times[run] >= edge && bin < JITTER_HISTOGRAM_BINS - 1; edge *= 2.0)
+            bin++;
+        histogram[bin]++;
+    }
+
+    const double worst = times[worst_run];
+    qsort(times, runs, sizeof(double), compare_double);
+
+    fprintf(out, "%s\n    {\"plugin\": \"%s\", \"block_size\": %u, \"runs\": %u, \"budget_us\": %.3f, "
+                 "\"p50_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f, "
+                 "\"max_run\": %u, \"max_budget_ratio\": %.4f, \"histogram_us\": [",
+            *first ? "" : ",", plugin->name, block_size, runs, budget_us,
+            percentile(times, runs, 0.50), percentile(times, runs, 0.99), percentile(times, runs, 0.999),
+            worst, worst_run, worst / budget_us);
+
+    for (uint32_t bin = 0; bin < JITTER_HISTOGRAM_BINS; bin++)
+    {
+        if (bin < JITTER_HISTOGRAM_BINS - 1)
+            fprintf(out, "%s{\"below\": %u, \"count\": %u}", bin ? ", " : "", 1u << bin, histogram[bin]);
+        else
+            fprintf(out, ", {\"above\": %u, \"count\": %u}", 1u << (bin - 1), histogram[bin]);
+    }
+
+    fprintf(out, "]");
+
+    if (have_telemetry)
+    {
+        const double samples = telemetry.samples ? (double)telemetry.samples : 1.0;
+        const double gain_avg = telemetry.gain_chunks ? telemetry.gain_sum / (double)telemetry.gain_chunks : 1.0;
+
+        fprintf(out, ", \"telemetry\": {\"gain_min_db\": %.2f, \"gain_avg_db\": %.2f, \"gate_idle\": %.4f, "
+                     "\"gate_hold\": %.4f, \"gate_decay\": %.4f, \"gate_opens\": %llu, \"gate_closes\": %llu}",
+                20.0 * log10(telemetry.gain_min), 20.0 * log10(gain_avg),
+                telemetry.gate_samples[0] / samples, telemetry.gate_samples[1] / samples,
+                telemetry.gate_samples[2] / samples,
+                (unsigned long long)telemetry.gate_opens, (unsigned long long)telemetry.gate_closes);
+    }
+
+    fprintf(out, "}");
+    fflush(out);
+    *first = 0;
+
+    free(times);
+    return 1;
+}
+
+//white noise under an exponential decay, evaluated in double so the float samples pass through
+//the denormal range on the way to zero like the end of a reverb or delay tail would
+static float *tail_signal(uint32_t length)
+{
+    float *signal = (float *)malloc(length * sizeof(float));
+    uint32_t seed = 7;
+
+    if (!signal)
+        return NULL;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const double noise = (double)(seed >> 8) * (2.0 / 16777216.0) - 1.0;
+        signal[i] = (float)(noise * pow(10.0, TAIL_FLOOR_DB * i / length / 20.0));
+    }
+
+    return signal;
+}
+
+static int bench_tail(FILE *out, const bench_options_t *opts, const float *signal, uint32_t length,
+                      const host_plugin_t *plugin, uint32_t mode, int *first)
+{
+    const uint32_t band_length = length / TAIL_BANDS;
+    double best[TAIL_BANDS];
+    host_instance_t host;
+
+    if (!bench_open(&host, opts, plugin))
+        return 0;
+
+    host_set_mode(&host, mode);
+
+    for (uint32_t r = 0; r <= opts->repetitions; r++)
+    {
+        for (uint32_t band = 0; band < TAIL_BANDS; band++)
+        {
+            const double elapsed = run_signal(&host, signal + band * band_length, band_length, TAIL_BLOCK);
+
+            //the first pass only warms up
+            if (r == 1 || (r > 1 && elapsed < best[band]))
+                best[band] = elapsed;
+        }
+    }
+
+    host_close(&host);
+
+    fprintf(out, "%s\n    {\"plugin\": \"%s\", \"mode\": \"%s\", \"block_size\": %u, \"bands\": [",
+            *first ? "" : ",", plugin->name, plugin->n_modes ? plugin->modes[mode].label : "default", TAIL_BLOCK);
+
+    for (uint32_t band = 0; band < TAIL_BANDS; band++)
+        fprintf(out, "%s{\"from_db\": %.1f, \"to_db\": %.1f, \"ns_per_sample\": %.3f}", band ? ", " : "",
+                TAIL_FLOOR_DB * band / TAIL_BANDS, TAIL_FLOOR_DB * (band + 1) / TAIL_BANDS, best[band] / band_length);
+
+    //cost of the denormal and silent end against the audible start
+    fprintf(out, "], \"tail_ratio\": %.2f}", best[TAIL_BANDS - 1] / best[0]);
+    fflush(out);
+    *first = 0;
+
+    return 1;
+}
+
+//reads back the throughput results of a file written by this tool, one result per line
+static uint32_t read_results(const char *path, bench_result_t *results)
+{
+    char line[1024];
+    uint32_t count = 0;
+    FILE *file = fopen(path, "r");
+
+    if (!file)
+    {
+        perror(path);
+        return 0;
+    }
+
+    while (count < COMPARE_MAX_RESULTS && fgets(line, sizeof(line), file))
+    {
+        bench_result_t *r = &results[count];
+
+        if (sscanf(line, " {\"plugin\": \"%63[^\"]\", \"mode\": \"%31[^\"]\", \"block_size\": %u, \"ns_per_sample\": %lf",
+                   r->plugin, r->mode, &r->block_size, &r->ns_per_sample) == 4)
+            count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+//speedup per plugin as the geometric mean over all modes and block sizes found in both files
+static int compare_results(const char *baseline_path, const char *current_path)
+{
+    static bench_result_t baseline[COMPARE_MAX_RESULTS], current[COMPARE_MAX_RESULTS];
+    const uint32_t n_baseline = read_results(baseline_path, baseline);
+    const uint32_t n_current = read_results(current_path, current);
+
+    if (!n_baseline || !n_current)
+        return 0;
+
+    printf("%-24s %8s %8s\n", "plugin", "speedup", "points");
+
+    for (uint32_t p = 0; p < host_plugin_count; p++)
+    {
+        double log_sum = 0.0;
+        uint32_t points = 0;
+
+        for (uint32_t c = 0; c < n_current; c++)
+        {
+            if (strcmp(current[c].plugin, host_plugins[p].name) != 0)
+                continue;
+
+            for (uint32_t b = 0; b < n_baseline; b++)
+            {
+                if (strcmp(baseline[b].plugin, current[c].plugin) == 0 && strcmp(baseline[b].mode, current[c].mode) == 0
+                    && baseline[b].block_size == current[c].block_size)
+                {
+                    log_sum += log(baseline[b].ns_per_sample / current[c].ns_per_sample);
+                    points++;
+                    break;
+                }
+            }
+        }
+
+        if (points)
+            printf("%-24s %7.3fx %8u\n", host_plugins[p].name, exp(log_sum / points), points);
+    }
+
+    return 1;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-C] [-r repo-root] [-p plugin] [-s seconds] [-n repetitions] [-o output.json [-c baseline.json]]\n"
+                    "       %s -j [-b block-size] [-C] [-r repo-root] [-p plugin] [-s seconds] [-n repetitions] [-o output.json]\n"
+                    "       %s -t [-C] [-r repo-root] [-p plugin] [-s seconds] [-n repetitions] [-o output.json]\n",
+            name, name, name);
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opts = { "..", NULL, 2.0, 3, 0, 0, 0, 64 };
+    const char *output = NULL, *baseline = NULL;
+    corpus_t corpus;
+    int opt, first = 1, failed = 0;
+
+    while ((opt = getopt(argc, argv, "r:p:s:n:o:c:jtCb:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': opts.root = optarg; break;
+            case 'p': opts.only = optarg; break;
+            case 's': opts.seconds = atof(optarg); break;
+            case 'n': opts.repetitions = (uint32_t)atoi(optarg); break;
+            case 'o': output = optarg; break;
+            case 'c': baseline = optarg; break;
+            case 'j': opts.jitter = 1; break;
+            case 't': opts.tail = 1; break;
+            case 'C': opts.combined = 1; break;
+            case 'b': opts.block_size = (uint32_t)atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (opts.seconds <= 0.0 || opts.repetitions == 0 || opts.block_size == 0 || opts.block_size > BENCH_MAX_BLOCK
+        || (opts.jitter && opts.tail) || (baseline && (!output || opts.jitter || opts.tail)))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.only && !host_find_plugin(opts.only))
+    {
+        fprintf(stderr, "unknown plugin %s\n", opts.only);
+        return 1;
+    }
+
+    //-ffast-math links in startup code that flushes denormals for the whole process, a real host
+    //does not necessarily do that, so the plugins run in the default floating point environment
+    fesetenv(FE_DFL_ENV);
+
+    if (!corpus_init(&corpus, BENCH_SAMPLE_RATE, (uint32_t)(opts.seconds * BENCH_SAMPLE_RATE)))
+        return 1;
+
+    float *tail = opts.tail ? tail_signal(corpus.length) : NULL;
+    FILE *out = (opts.tail && !tail) ? NULL : output ? fopen(output, "w") : stdout;
+    if (!out)
+    {
+        perror(output ? output : "tail");
+        free(tail);
+        corpus_free(&corpus);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"%s\",\n  \"sample_rate\": %u,\n  \"signal_seconds\": %.3f,\n  \"repetitions\": %u,\n  \"results\": [",
+            opts.jitter ? "jitter" : opts.tail ? "tail" : "throughput", BENCH_SAMPLE_RATE, opts.seconds, opts.repetitions);
+
+    for (uint32_t p = 0; p < host_plugin_count; p++)
+    {
+        const host_plugin_t *plugin = &host_plugins[p];
+        const uint32_t modes = plugin->n_modes ? plugin->n_modes : 1;
+
+        if (opts.only && strcmp(opts.only, plugin->name) != 0)
+            continue;
+
+        if (opts.jitter)
+        {
+            failed |= !bench_jitter(out, &opts, &corpus, plugin, &first);
+            continue;
+        }
+
+        int ok = 1;
+        for (uint32_t m = 0; opts.tail && ok && m < modes; m++)
+            ok = bench_tail(out, &opts, tail, corpus.length, plugin, m, &first);
+
+        for (uint32_t m = 0; !opts.tail && ok && m < modes; m++)
+        {
+            for (uint32_t block = BENCH_MIN_BLOCK; ok && block <= BENCH_MAX_BLOCK; block *= 2)
+                ok = bench_mode(out, &opts, &corpus, plugin, m, block, &first);
+        }
+        failed |= !ok;
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+
+    if (output)
+        fclose(out);
+    free(tail);
+    corpus_free(&corpus);
+
+    if (baseline && !failed)
+        failed = !compare_results(baseline, output);
+
+    if (host_rt_violations() > 0)
+    {
+        fprintf(stderr, "%u calls inside run() are not real-time safe\n", host_rt_violations());
+        failed = 1;
+    }
+
+    return failed;
+}
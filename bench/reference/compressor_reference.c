@@ -18,7 +18,10 @@
  * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
-#include "compressor_core.h"
+// frozen scalar copy of dsp/compressor_core, render-check compares the library against it
+// keep it as it is, optimizations and approximations belong in dsp/
+
+#include "compressor_reference.h"
 #include <math.h>
 #include <string.h>
 
@@ -41,10 +44,10 @@ static inline float compcurve(float x, float k, float slope, float linearthresho
 	if (x < linearthreshold)
 		return x;
 	if (knee <= 0.0f) // no knee in curve
-		return cmop_db2lin(threshold + slope * (lin2db(x) - threshold));
+		return reference_db2lin(threshold + slope * (lin2db(x) - threshold));
 	if (x < linearthresholdknee)
 		return kneecurve(x, k, linearthreshold);
-	return cmop_db2lin(kneedboffset + slope * (lin2db(x) - threshold - knee));
+	return reference_db2lin(kneedboffset + slope * (lin2db(x) - threshold - knee));
 }
 
 // for more information on the adaptive release curve, check out adaptive-release-curve.html demo +
@@ -73,11 +76,11 @@ static inline float fixf(float v, float def){
 	return v;
 }
 
-float cmop_db2lin(float db){ // dB to linear
+float reference_db2lin(float db){ // dB to linear
 	return powf(10.0f, 0.05f * db);
 }
 
-void compressor_init(sf_compressor_state_st *state, int samplerate)
+void reference_compressor_init(reference_compressor_state_st *state, int samplerate)
 {
 	state->samplerate = samplerate;
 	state->detectoravg = 0.0f;
@@ -90,11 +93,11 @@ void compressor_init(sf_compressor_state_st *state, int samplerate)
 
 // this is the main initialization function
 // it does a bunch of pre-calculation so that the inner loop of signal processing is fast
-void compressor_set_params(sf_compressor_state_st *state, float threshold,
+void reference_compressor_set_params(reference_compressor_state_st *state, float threshold,
 	float knee, float ratio, float attack, float release, float makeup){
 
 	// useful values
-	float linearthreshold = cmop_db2lin(threshold);
+	float linearthreshold = reference_db2lin(threshold);
 	float slope = 1.0f / ratio;
 	float attacksamples = state->samplerate * attack;
 	float attacksamplesinv = 1.0f / attacksamples;
@@ -107,7 +110,7 @@ void compressor_set_params(sf_compressor_state_st *state, float threshold,
 	float kneedboffset = 0.0f;
 	float linearthresholdknee = 0.0f;
 	if (knee > 0.0f){ // if a knee exists, search for a good k value
-		float xknee = cmop_db2lin(threshold + knee);
+		float xknee = reference_db2lin(threshold + knee);
 		float mink = 0.1f;
 		float maxk = 10000.0f;
 		// search by comparing the knee slope at the current k guess, to the ideal slope
@@ -119,13 +122,13 @@ void compressor_set_params(sf_compressor_state_st *state, float threshold,
 			k = sqrtf(mink * maxk);
 		}
 		kneedboffset = lin2db(kneecurve(xknee, k, linearthreshold));
-		linearthresholdknee = cmop_db2lin(threshold + knee);
+		linearthresholdknee = reference_db2lin(threshold + knee);
 	}
 
 	// calculate a master gain based on what sounds good
 	float fulllevel = compcurve(1.0f, k, slope, linearthreshold, linearthresholdknee,
 		threshold, knee, kneedboffset);
-	float mastergain = cmop_db2lin(makeup) * powf(1.0f / fulllevel, 0.6f);
+	float mastergain = reference_db2lin(makeup) * powf(1.0f / fulllevel, 0.6f);
 
 	// calculate the adaptive release curve parameters
 	// solve a,b,c,d in `y = a*x^3 + b*x^2 + c*x + d`
@@ -156,7 +159,7 @@ void compressor_set_params(sf_compressor_state_st *state, float threshold,
 	state->d                    = d;
 }
 
-void compressor_process(sf_compressor_state_st *state, int size, const float *input_L, const float *input_R, float *output_L, float *output_R)
+void reference_compressor_process(reference_compressor_state_st *state, int size, const float *input_L, const float *input_R, float *output_L, float *output_R)
 {
 	// pull out the state into local variables
 	float threshold            = state->threshold;
@@ -177,8 +180,8 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 	float compgain             = state->compgain;
 	float maxcompdiffdb        = state->maxcompdiffdb;
 
-	int chunks = size > SF_COMPRESSOR_SPU ? size / SF_COMPRESSOR_SPU : 1;
-	int spu = size > SF_COMPRESSOR_SPU ? SF_COMPRESSOR_SPU : size;
+	int chunks = size > REFERENCE_COMPRESSOR_SPU ? size / REFERENCE_COMPRESSOR_SPU : 1;
+	int spu = size > REFERENCE_COMPRESSOR_SPU ? REFERENCE_COMPRESSOR_SPU : size;
 	int samplepos = 0;
 
 	for (int ch = 0; ch < chunks; ch++){
@@ -196,7 +199,7 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 			// scale compdiffdb between 0-3
 			float x = (clampf(compdiffdb, -12.0f, 0.0f) + 12.0f) * 0.25f;
 			float releasesamples = adaptivereleasecurve(x, a, b, c, d);
-			enveloperate = cmop_db2lin(5.0f / releasesamples);
+			enveloperate = reference_db2lin(5.0f / releasesamples);
 		}
 		else{ // compresorgain > scaleddesiredgain, so we're attacking
 			compdiffdb = fixf(compdiffdb, 1.0f);
@@ -232,7 +235,7 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 				if (attenuationdb < 2.0f)
 					attenuationdb = 2.0f;
 				float dbpersample = attenuationdb * satreleasesamplesinv;
-				rate = cmop_db2lin(dbpersample) - 1.0f;
+				rate = reference_db2lin(dbpersample) - 1.0f;
 			}
 			else
 				rate = 1.0f;
@@ -18,12 +18,15 @@
  * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
-#ifndef COMPRESSOR_CORE__H
-#define COMPRESSOR_CORE__H
+// frozen scalar copy of dsp/compressor_core, render-check compares the library against it
+// keep it as it is, optimizations and approximations belong in dsp/
+
+#ifndef COMPRESSOR_REFERENCE__H
+#define COMPRESSOR_REFERENCE__H
 
 // samples per update; the compressor works by dividing the input chunks into even smaller sizes,
 // and performs heavier calculations after each mini-chunk to adjust the final envelope
-#define SF_COMPRESSOR_SPU        32
+#define REFERENCE_COMPRESSOR_SPU        32
 
 typedef struct {
 	float threshold;
@@ -47,17 +50,17 @@ typedef struct {
 	float samplerate;
 	float ang90;
 	float ang90inv;
-} sf_compressor_state_st;
+} reference_compressor_state_st;
 
-float cmop_db2lin(float db);
+float reference_db2lin(float db);
 
-void compressor_init(sf_compressor_state_st *state, int samplerate);
+void reference_compressor_init(reference_compressor_state_st *state, int samplerate);
 
 // this function will process the input sound based on the state passed
 // the input and output buffers should be the same size
-void compressor_process(sf_compressor_state_st *state, int size, const float *input_L, const float *input_R, float *output_L, float *output_R);
+void reference_compressor_process(reference_compressor_state_st *state, int size, const float *input_L, const float *input_R, float *output_L, float *output_R);
 
-void compressor_set_params(sf_compressor_state_st *state, float threshold,
+void reference_compressor_set_params(reference_compressor_state_st *state, float threshold,
 	float knee, float ratio, float attack, float release, float makeup);
 
-#endif //COMPRESSOR_CORE__H
+#endif //COMPRESSOR_REFERENCE__H
@@ -0,0 +1,558 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+
+// output regression checks, there are no unit tests in this repository so this is run by hand or by 'make check':
+//  -w dir  renders the corpus through every plugin over a parameter grid and stores the outputs
+//  -c dir  renders the same grid and compares it against the stored outputs
+//  -e      compares the optimized dsp kernels against their scalar reference
+// deviations are the peak absolute difference in dBFS, anything above the tolerance fails
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <float.h>
+#include <math.h>
+
+#include "lv2-host.h"
+#include "corpus.h"
+
+#include "compressor_core.h"
+#include "gate_core.h"
+#include "dsp_tables.h"
+#include "reference/compressor_reference.h"
+
+#define CHECK_SAMPLE_RATE 48000
+#define CHECK_BLOCK 64
+#define CHECK_TOLERANCE_DB -100.0
+#define CHECK_NAME_SIZE 96
+#define CHECK_MAX_OUTPUTS 16
+#define CHECK_TABLE_POINTS (1 << 20)
+//float rounding of the lookups on top of the interpolation error gen-tables measured
+#define CHECK_TABLE_ROUNDING (16 * FLT_EPSILON)
+
+static const char check_magic[8] = { 'M', 'O', 'D', 'R', 'E', 'F', '0', '1' };
+
+typedef struct {
+    double worst;
+    char worst_case[CHECK_NAME_SIZE];
+    uint32_t cases, failed;
+} check_result_t;
+
+static double peak_error_db(const float *a, const float *b, uint32_t n)
+{
+    float peak = 0.0f;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const float d = fabsf(a[i] - b[i]);
+        //a NaN on either side is a failure, not a zero difference
+        if (d != d)
+            return INFINITY;
+        peak = d > peak ? d : peak;
+    }
+
+    return peak > 0.0f ? 20.0 * log10(peak) : -INFINITY;
+}
+
+static void check_record(check_result_t *result, const char *name, double error, double tolerance)
+{
+    result->cases++;
+
+    if (error > tolerance)
+        result->failed++;
+
+    if (result->cases == 1 || error > result->worst)
+    {
+        result->worst = error;
+        snprintf(result->worst_case, sizeof(result->worst_case), "%s", name);
+    }
+}
+
+static int check_report(const char *name, const check_result_t *result)
+{
+    printf("%-28s %5u cases, worst %8.1f dB (%s) %s\n", name, result->cases, result->worst,
+           result->worst_case, result->failed ? "FAIL" : "ok");
+    return result->failed == 0;
+}
+
+// --------------------------------------------------------------
+// golden outputs of the plugin binaries
+
+typedef struct {
+    FILE *file;
+    int writing;
+    double tolerance;
+    check_result_t result;
+} golden_t;
+
+static uint32_t plugin_outputs(const host_plugin_t *plugin, uint32_t *indices)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < plugin->n_ports && count < CHECK_MAX_OUTPUTS; i++)
+    {
+        if (plugin->ports[i].type == HOST_PORT_AUDIO_OUT || plugin->ports[i].type == HOST_PORT_CV_OUT)
+            indices[count++] = plugin->ports[i].index;
+    }
+
+    return count;
+}
+
+//set by -C, renders from the combined bundle instead of the single plugin bundles
+static int check_combined = 0;
+
+//renders one signal from a fresh instance, outputs are stored channel after channel
+static int render_case(const host_plugin_t *plugin, const char *root, const float *signal, uint32_t length,
+                       int32_t mode, int32_t port, float value, float *rendered)
+{
+    uint32_t outputs[CHECK_MAX_OUTPUTS];
+    const uint32_t n_outputs = plugin_outputs(plugin, outputs);
+    host_instance_t host;
+
+    if (!(check_combined ? host_open_combined(&host, plugin, root, CHECK_SAMPLE_RATE, CHECK_BLOCK)
+                         : host_open(&host, plugin, root, CHECK_SAMPLE_RATE, CHECK_BLOCK)))
+        return 0;
+
+    if (mode >= 0)
+        host_set_mode(&host, (uint32_t)mode);
+    if (port >= 0)
+        host_set_control(&host, (uint32_t)port, value);
+
+    for (uint32_t pos = 0; pos < length; pos += CHECK_BLOCK)
+    {
+        const uint32_t n = length - pos < CHECK_BLOCK ? length - pos : CHECK_BLOCK;
+
+        host_run(&host, signal + pos, n);
+
+        for (uint32_t o = 0; o < n_outputs; o++)
+            memcpy(rendered + o * length + pos, host.buffers[outputs[o]], n * sizeof(float));
+    }
+
+    host_close(&host);
+    return 1;
+}
+
+static int golden_case(golden_t *golden, const char *name, const float *rendered, uint32_t size)
+{
+    char stored_name[CHECK_NAME_SIZE] = { 0 };
+
+    if (golden->writing)
+    {
+        snprintf(stored_name, sizeof(stored_name), "%s", name);
+        return fwrite(stored_name, sizeof(stored_name), 1, golden->file) == 1
+            && fwrite(rendered, sizeof(float), size, golden->file) == size;
+    }
+
+    float *stored = (float *)malloc(size * sizeof(float));
+    int ok = stored
+          && fread(stored_name, sizeof(stored_name), 1, golden->file) == 1
+          && strncmp(stored_name, name, sizeof(stored_name)) == 0
+          && fread(stored, sizeof(float), size, golden->file) == size;
+
+    if (ok)
+        check_record(&golden->result, name, peak_error_db(rendered, stored, size), golden->tolerance);
+    else
+        fprintf(stderr, "reference does not match the grid at %s, regenerate it with -w\n", name);
+
+    free(stored);
+    return ok;
+}
+
+//the grid is every mode with all controls at their defaults, then each control alone at its minimum and maximum
+static int golden_plugin(const host_plugin_t *plugin, const char *root, const char *dir, const corpus_t *corpus,
+                         int writing, double tolerance)
+{
+    uint32_t outputs[CHECK_MAX_OUTPUTS];
+    const uint32_t n_outputs = plugin_outputs(plugin, outputs);
+    const uint32_t size = n_outputs * corpus->length;
+    const uint32_t modes = plugin->n_modes ? plugin->n_modes : 1;
+    const uint32_t header[2] = { corpus->length, CHECK_BLOCK };
+    uint32_t stored_header[2];
+    char magic[sizeof(check_magic)];
+    char path[4096], name[CHECK_NAME_SIZE];
+    golden_t golden;
+    int ok = 1;
+
+    memset(&golden, 0, sizeof(golden));
+    golden.writing = writing;
+    golden.tolerance = tolerance;
+
+    snprintf(path, sizeof(path), "%s/%s.ref", dir, plugin->name);
+    golden.file = fopen(path, writing ? "wb" : "rb");
+    if (!golden.file)
+    {
+        perror(path);
+        return 0;
+    }
+
+    if (writing)
+    {
+        ok = fwrite(check_magic, sizeof(check_magic), 1, golden.file) == 1
+          && fwrite(header, sizeof(header), 1, golden.file) == 1;
+    }
+    else
+    {
+        ok = fread(magic, sizeof(magic), 1, golden.file) == 1 && memcmp(magic, check_magic, sizeof(magic)) == 0
+          && fread(stored_header, sizeof(stored_header), 1, golden.file) == 1
+          && memcmp(stored_header, header, sizeof(header)) == 0;
+        if (!ok)
+            fprintf(stderr, "%s: not a reference for this corpus length and block size\n", path);
+    }
+
+    float *rendered = (float *)malloc(size * sizeof(float));
+    ok = ok && rendered;
+
+    for (uint32_t m = 0; ok && m < modes; m++)
+    {
+        const char *mode_name = plugin->n_modes ? plugin->modes[m].label : "default";
+
+        for (int32_t p = -1; ok && p < (int32_t)plugin->n_ports; p++)
+        {
+            const host_port_t *port = p >= 0 ? &plugin->ports[p] : NULL;
+
+            if (port && (port->type != HOST_PORT_CONTROL_IN || (int32_t)port->index == plugin->mode_port))
+                continue;
+
+            for (int extreme = 0; ok && extreme < (port ? 2 : 1); extreme++)
+            {
+                const float value = port ? (extreme ? port->max : port->min) : 0.0f;
+
+                for (int s = 0; ok && s < CORPUS_COUNT; s++)
+                {
+                    if (port)
+                        snprintf(name, sizeof(name), "%s/%s=%g/%s", mode_name, port->symbol, value, corpus_names[s]);
+                    else
+                        snprintf(name, sizeof(name), "%s/defaults/%s", mode_name, corpus_names[s]);
+
+                    ok = render_case(plugin, root, corpus->signals[s], corpus->length, plugin->n_modes ? (int32_t)m : -1,
+                                     port ? (int32_t)port->index : -1, value, rendered)
+                      && golden_case(&golden, name, rendered, size);
+                }
+            }
+        }
+    }
+
+    free(rendered);
+    fclose(golden.file);
+
+    if (!ok)
+        return 0;
+
+    if (writing)
+    {
+        printf("%-28s wrote %s\n", plugin->name, path);
+        return 1;
+    }
+
+    return check_report(plugin->name, &golden.result);
+}
+
+// --------------------------------------------------------------
+// optimized kernels against their scalar reference
+
+//the generated lookup tables against libm, in the units of dsp_table_*_error
+static double table_error(int table, double x)
+{
+    switch (table)
+    {
+        case 0: //x in [0, 1]
+            return fabs(dsp_sine_gain((float)x) - sin(M_PI * 0.5 * (float)x));
+        case 1: //-120 to +24 dB
+        {
+            const float db = (float)(-120.0 + 144.0 * x);
+            const double exact = pow(10.0, db / 20.0);
+            return fabs(dsp_db2lin(db) - exact) / exact;
+        }
+        default: //-80 to +12 dB, the range of compcurve and the release detector
+        {
+            const float lin = (float)pow(10.0, (-80.0 + 92.0 * x) / 20.0);
+            return fabs(dsp_lin2db(lin) - 20.0 * log10(lin)) * M_LN10 / 20.0;
+        }
+    }
+}
+
+static int equivalence_tables(double tolerance)
+{
+    static const char *const names[3] = { "sine gain", "db2lin", "lin2db" };
+    const double bounds[3] = { dsp_table_sine_error, dsp_table_exp2_error, dsp_table_log2_error };
+    check_result_t result;
+
+    memset(&result, 0, sizeof(result));
+
+    for (int t = 0; t < 3; t++)
+    {
+        const double limit = 20.0 * log10(bounds[t] + CHECK_TABLE_ROUNDING);
+        double worst = 0.0;
+
+        for (uint32_t i = 0; i <= CHECK_TABLE_POINTS; i++)
+        {
+            const double error = table_error(t, (double)i / CHECK_TABLE_POINTS);
+            //a NaN is a failure, not a zero difference
+            if (error != error)
+                worst = INFINITY;
+            worst = error > worst ? error : worst;
+        }
+
+        check_record(&result, names[t], worst > 0.0 ? 20.0 * log10(worst) : -INFINITY,
+                     limit < tolerance ? limit : tolerance);
+    }
+
+    return check_report("dsp_tables", &result);
+}
+
+static int equivalence_compressor(const corpus_t *corpus, double tolerance)
+{
+    //the system compressor presets and the advanced compressor defaults
+    static const float presets[][6] = {
+        { -12.0f, 12.0f, 2.0f, 0.0001f, 0.1f, -3.0f },
+        { -12.0f, 12.0f, 3.0f, 0.0001f, 0.1f, -3.0f },
+        { -15.0f, 15.0f, 4.0f, 0.0001f, 0.1f, -3.0f },
+        { -25.0f, 15.0f, 10.0f, 0.0001f, 0.5f, -6.0f },
+        { -20.0f, 20.0f, 1.0f, 0.01f, 0.1f, 0.0f },
+        { -40.0f, 0.0f, 20.0f, 0.001f, 1.0f, 12.0f },
+    };
+    const uint32_t length = corpus->length;
+    float *out = (float *)malloc(4 * length * sizeof(float));
+    check_result_t result;
+    char name[CHECK_NAME_SIZE];
+
+    if (!out)
+        return 0;
+
+    memset(&result, 0, sizeof(result));
+
+    for (uint32_t p = 0; p < sizeof(presets) / sizeof(presets[0]); p++)
+    {
+        const float *v = presets[p];
+
+        for (int s = 0; s < CORPUS_COUNT; s++)
+        {
+            const float *in = corpus->signals[s];
+            sf_compressor_state_st state;
+            reference_compressor_state_st reference;
+
+            compressor_init(&state, CHECK_SAMPLE_RATE);
+            compressor_set_params(&state, v[0], v[1], v[2], v[3], v[4], v[5]);
+            reference_compressor_init(&reference, CHECK_SAMPLE_RATE);
+            reference_compressor_set_params(&reference, v[0], v[1], v[2], v[3], v[4], v[5]);
+
+            for (uint32_t pos = 0; pos + CHECK_BLOCK <= length; pos += CHECK_BLOCK)
+            {
+                compressor_process(&state, CHECK_BLOCK, in + pos, in + pos, out + pos, out + length + pos);
+                reference_compressor_process(&reference, CHECK_BLOCK, in + pos, in + pos,
+                                             out + 2 * length + pos, out + 3 * length + pos);
+            }
+
+            snprintf(name, sizeof(name), "preset %u/%s", p, corpus_names[s]);
+            const double left = peak_error_db(out, out + 2 * length, length - length % CHECK_BLOCK);
+            const double right = peak_error_db(out + length, out + 3 * length, length - length % CHECK_BLOCK);
+            check_record(&result, name, left > right ? left : right, tolerance);
+        }
+    }
+
+    free(out);
+    return check_report("compressor_process", &result);
+}
+
+static int equivalence_power_block(const corpus_t *corpus, double tolerance)
+{
+    check_result_t result;
+    char name[CHECK_NAME_SIZE];
+    float block[CHECK_BLOCK], scalar[CHECK_BLOCK];
+
+    memset(&result, 0, sizeof(result));
+
+    for (uint32_t size = 16; size <= RINGBUFFER_MAX_SIZE; size *= 4)
+    {
+        for (int s = 0; s < CORPUS_COUNT; s++)
+        {
+            const float *in = corpus->signals[s];
+            ringbuffer_t a, b;
+            double worst = -INFINITY;
+
+            if (!ringbuffer_init(&a, size, NULL) || !ringbuffer_init(&b, size, NULL))
+                return 0;
+
+            for (uint32_t pos = 0; pos + CHECK_BLOCK <= corpus->length; pos += CHECK_BLOCK)
+            {
+                ringbuffer_push_and_calculate_power_block(&a, in + pos, block, CHECK_BLOCK);
+                for (uint32_t i = 0; i < CHECK_BLOCK; i++)
+                    scalar[i] = ringbuffer_push_and_calculate_power(&b, in[pos + i]);
+
+                const double error = peak_error_db(block, scalar, CHECK_BLOCK);
+                worst = error > worst ? error : worst;
+            }
+
+            ringbuffer_free(&a);
+            ringbuffer_free(&b);
+
+            snprintf(name, sizeof(name), "window %u/%s", size, corpus_names[s]);
+            check_record(&result, name, worst, tolerance);
+        }
+    }
+
+    return check_report("power_block", &result);
+}
+
+//Gate_RunBlock and Gate_RunBlockLinked against the per sample calls, at full and decimated key rate
+static int equivalence_gate(const corpus_t *corpus, int linked, double tolerance)
+{
+    //the factors of a DSP_GATE_KEY_DECIMATION build, checked whether this build uses them or not
+    static const uint32_t rates[] = { 48000, 96000, 192000 };
+    static const uint32_t decimations[] = { 1, 4, 8 };
+    const uint32_t length = corpus->length - corpus->length % GATE_BLOCK_SIZE;
+    float *block = (float *)malloc(length * sizeof(float));
+    float *scalar = (float *)malloc(length * sizeof(float));
+    float cv[GATE_BLOCK_SIZE];
+    check_result_t result;
+    char name[CHECK_NAME_SIZE];
+
+    if (!block || !scalar)
+    {
+        free(block);
+        free(scalar);
+        return 0;
+    }
+
+    memset(&result, 0, sizeof(result));
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        for (int key = GATE_KEY_AVERAGE; key <= (linked ? GATE_KEY_AVERAGE : GATE_KEY_PEAK); key++)
+        {
+            for (int s = 0; s < CORPUS_COUNT; s++)
+            {
+                const float *in = corpus->signals[s];
+                const uint32_t decimation = decimations[r];
+                gate_t a, b;
+
+                if (!Gate_Init(&a, rates[r], GATE_DEFAULT_WINDOW_MS, 1, decimation, NULL)
+                    || !Gate_Init(&b, rates[r], GATE_DEFAULT_WINDOW_MS, 1, decimation, NULL))
+                    return 0;
+
+                Gate_UpdateParameters(&a, rates[r], 10, 10, 50, 1, -40.0f, -50.0f);
+                Gate_UpdateParameters(&b, rates[r], 10, 10, 50, 1, -40.0f, -50.0f);
+                Gate_SetKeyMode(&a, (gate_key_mode_t)key);
+                Gate_SetKeyMode(&b, (gate_key_mode_t)key);
+
+                for (uint32_t pos = 0; pos < length; pos += GATE_BLOCK_SIZE)
+                {
+                    if (linked)
+                    {
+                        //two channels, the second one half as loud, the key is the louder of both
+                        float half[GATE_BLOCK_SIZE], half_out[GATE_BLOCK_SIZE];
+                        for (uint32_t i = 0; i < GATE_BLOCK_SIZE; i++)
+                            half[i] = in[pos + i] * -0.5f;
+
+                        const float *ins[2] = { in + pos, half };
+                        float *outs[2] = { block + pos, half_out };
+                        Gate_RunBlockLinked(&a, ins, outs, 2, GATE_BLOCK_SIZE);
+                    }
+                    else
+                        Gate_RunBlock(&a, in + pos, in + pos, block + pos, cv, GATE_BLOCK_SIZE, GATE_CV_GAIN);
+
+                    for (uint32_t i = pos; i < pos + GATE_BLOCK_SIZE; i++)
+                    {
+                        Gate_PushSample(&b, linked ? fabsf(in[i]) : in[i]);
+                        scalar[i] = Gate_RunGate(&b, in[i]);
+                    }
+                }
+
+                Gate_Cleanup(&a);
+                Gate_Cleanup(&b);
+
+                snprintf(name, sizeof(name), "%u Hz/%s/%s", rates[r], key == GATE_KEY_PEAK ? "peak" : "average",
+                         corpus_names[s]);
+                check_record(&result, name, peak_error_db(block, scalar, length), tolerance);
+            }
+        }
+    }
+
+    free(block);
+    free(scalar);
+    return check_report(linked ? "Gate_RunBlockLinked" : "Gate_RunBlock", &result);
+}
+
+// --------------------------------------------------------------
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s -w reference-dir [-r repo-root] [-p plugin] [-s seconds]\n"
+                    "       %s -c reference-dir [-C] [-r repo-root] [-p plugin] [-s seconds] [-t tolerance-db]\n"
+                    "       %s -e [-s seconds] [-t tolerance-db]\n", name, name, name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *root = "..", *only = NULL, *dir = NULL;
+    double seconds = 1.0, tolerance = CHECK_TOLERANCE_DB;
+    int opt, writing = 0, equivalence = 0, ok = 1;
+    corpus_t corpus;
+
+    while ((opt = getopt(argc, argv, "w:c:eCr:p:s:t:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w': dir = optarg; writing = 1; break;
+            case 'c': dir = optarg; writing = 0; break;
+            case 'e': equivalence = 1; break;
+            case 'C': check_combined = 1; break;
+            case 'r': root = optarg; break;
+            case 'p': only = optarg; break;
+            case 's': seconds = atof(optarg); break;
+            case 't': tolerance = atof(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if ((!dir && !equivalence) || seconds <= 0.0 || (only && !host_find_plugin(only)))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!corpus_init(&corpus, CHECK_SAMPLE_RATE, (uint32_t)(seconds * CHECK_SAMPLE_RATE)))
+        return 1;
+
+    if (equivalence)
+    {
+        ok = equivalence_tables(tolerance) && ok;
+        ok = equivalence_compressor(&corpus, tolerance) && ok;
+        ok = equivalence_power_block(&corpus, tolerance) && ok;
+        ok = equivalence_gate(&corpus, 0, tolerance) && ok;
+        ok = equivalence_gate(&corpus, 1, tolerance) && ok;
+    }
+
+    for (uint32_t p = 0; dir && p < host_plugin_count; p++)
+    {
+        if (only && strcmp(only, host_plugins[p].name) != 0)
+            continue;
+
+        ok = golden_plugin(&host_plugins[p], root, dir, &corpus, writing, tolerance) && ok;
+    }
+
+    corpus_free(&corpus);
+
+    if (host_rt_violations() > 0)
+    {
+        fprintf(stderr, "%u calls inside run() are not real-time safe\n", host_rt_violations());
+        ok = 0;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,534 @@
+/*
+ * mod-system-plugins benchmarks
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// real-time safety checker, preloaded into plugin-bench or render-check:
+//   LD_PRELOAD=./rt-check.so ./plugin-bench -j
+// The host stand-in calls rt_check_run_begin/end around every run() when it finds them (see lv2-host.c).
+// Any allocation, mutex or condition variable operation, file or stdio call, sleep, poll or memory
+// mapping made by that thread in between is reported with a backtrace, and the host fails at exit.
+// RT_CHECK_ABORT=1 aborts on the first violation instead, to get a core dump.
+// Only calls that go through the dynamic symbol table are seen; inline syscalls or calls inside
+// libc itself are not, so this catches what plugin code does, not everything the kernel sees.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+
+#define RT_CHECK_EXPORT __attribute__((visibility("default")))
+#define RT_CHECK_FRAMES 32
+
+// a call made every block would report thousands of times, the rest are only counted
+#define RT_CHECK_REPORTS 16
+
+// dlsym may allocate while the allocator hooks are still being resolved, that is served from here
+#define RT_CHECK_BOOTSTRAP_SIZE 4096
+
+static __thread int rt_depth;       // > 0 while this thread is inside run()
+static __thread int rt_reporting;   // the report itself may call the hooked functions
+static uint32_t rt_violations;
+static int rt_abort;
+
+static int rt_resolving;
+static uint8_t rt_bootstrap[RT_CHECK_BOOTSTRAP_SIZE] __attribute__((aligned(16)));
+static size_t rt_bootstrap_used;
+
+static ssize_t (*real_write)(int, const void *, size_t);
+
+// --------------------------------------------------------------
+// entry points looked up by the host
+
+RT_CHECK_EXPORT void rt_check_run_begin(void)
+{
+    rt_depth++;
+}
+
+RT_CHECK_EXPORT void rt_check_run_end(void)
+{
+    rt_depth--;
+}
+
+RT_CHECK_EXPORT uint32_t rt_check_violations(void)
+{
+    return __atomic_load_n(&rt_violations, __ATOMIC_RELAXED);
+}
+
+// --------------------------------------------------------------
+
+static void *rt_resolve(const char *name)
+{
+    rt_resolving++;
+    void *symbol = dlsym(RTLD_NEXT, name);
+    rt_resolving--;
+
+    //every hooked function is part of libc, without it there is nothing to forward to
+    if (!symbol)
+        abort();
+
+    return symbol;
+}
+
+#define RT_REAL(name) \
+    static __typeof__(name) *real; \
+    if (!real) \
+        real = (__typeof__(name) *)rt_resolve(#name)
+
+static void rt_write(const char *text, size_t length)
+{
+    if (!real_write)
+        real_write = (ssize_t (*)(int, const void *, size_t))rt_resolve("write");
+
+    while (length > 0)
+    {
+        const ssize_t written = real_write(STDERR_FILENO, text, length);
+        if (written <= 0)
+            return;
+        text += written;
+        length -= (size_t)written;
+    }
+}
+
+static void rt_violation(const char *function)
+{
+    if (rt_depth <= 0 || rt_reporting)
+        return;
+
+    rt_reporting = 1;
+
+    if (__atomic_add_fetch(&rt_violations, 1, __ATOMIC_RELAXED) > RT_CHECK_REPORTS && !rt_abort)
+    {
+        rt_reporting = 0;
+        return;
+    }
+
+    char line[128];
+    const int length = snprintf(line, sizeof(line), "rt-check: %s() called inside run()\n", function);
+    rt_write(line, (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+
+    //the first frame is this function
+    void *frames[RT_CHECK_FRAMES];
+    const int count = backtrace(frames, RT_CHECK_FRAMES);
+    backtrace_symbols_fd(frames + 1, count - 1, STDERR_FILENO);
+
+    if (rt_abort)
+        abort();
+
+    rt_reporting = 0;
+}
+
+__attribute__((constructor))
+static void rt_check_init(void)
+{
+    const char *value = getenv("RT_CHECK_ABORT");
+    rt_abort = value && value[0] == '1';
+
+    //backtrace loads libgcc on its first call, which allocates, so that happens here
+    void *frames[2];
+    backtrace(frames, 2);
+}
+
+__attribute__((destructor))
+static void rt_check_report(void)
+{
+    char line[96];
+    const uint32_t violations = rt_check_violations();
+    const int length = snprintf(line, sizeof(line), "rt-check: %u violations inside run()%s\n", violations,
+                                violations > RT_CHECK_REPORTS ? ", only the first ones are shown" : "");
+    rt_write(line, (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+}
+
+// --------------------------------------------------------------
+// memory
+
+static void *rt_bootstrap_alloc(size_t size)
+{
+    size = (size + 15) & ~(size_t)15;
+
+    if (size > RT_CHECK_BOOTSTRAP_SIZE - rt_bootstrap_used)
+        return NULL;
+
+    void *memory = rt_bootstrap + rt_bootstrap_used;
+    rt_bootstrap_used += size;
+    return memory;
+}
+
+static int rt_is_bootstrap(const void *memory)
+{
+    return (const uint8_t *)memory >= rt_bootstrap && (const uint8_t *)memory < rt_bootstrap + RT_CHECK_BOOTSTRAP_SIZE;
+}
+
+RT_CHECK_EXPORT void *malloc(size_t size)
+{
+    static void *(*real)(size_t);
+    if (!real)
+    {
+        if (rt_resolving)
+            return rt_bootstrap_alloc(size);
+        real = (void *(*)(size_t))rt_resolve("malloc");
+    }
+    rt_violation("malloc");
+    return real(size);
+}
+
+RT_CHECK_EXPORT void *calloc(size_t count, size_t size)
+{
+    static void *(*real)(size_t, size_t);
+    if (!real)
+    {
+        if (rt_resolving)
+            return rt_bootstrap_alloc(count * size); //static memory is already zero
+        real = (void *(*)(size_t, size_t))rt_resolve("calloc");
+    }
+    rt_violation("calloc");
+    return real(count, size);
+}
+
+RT_CHECK_EXPORT void *realloc(void *memory, size_t size)
+{
+    static void *(*real)(void *, size_t);
+    if (!real)
+        real = (void *(*)(void *, size_t))rt_resolve("realloc");
+    rt_violation("realloc");
+
+    if (rt_is_bootstrap(memory))
+    {
+        void *moved = malloc(size);
+        if (moved)
+        {
+            const size_t available = (size_t)(rt_bootstrap + RT_CHECK_BOOTSTRAP_SIZE - (uint8_t *)memory);
+            memcpy(moved, memory, size < available ? size : available);
+        }
+        return moved;
+    }
+
+    return real(memory, size);
+}
+
+RT_CHECK_EXPORT void free(void *memory)
+{
+    static void (*real)(void *);
+    if (rt_is_bootstrap(memory))
+        return;
+    if (!real)
+        real = (void (*)(void *))rt_resolve("free");
+    rt_violation("free");
+    real(memory);
+}
+
+RT_CHECK_EXPORT int posix_memalign(void **memory, size_t alignment, size_t size)
+{
+    RT_REAL(posix_memalign);
+    rt_violation("posix_memalign");
+    return real(memory, alignment, size);
+}
+
+RT_CHECK_EXPORT void *aligned_alloc(size_t alignment, size_t size)
+{
+    RT_REAL(aligned_alloc);
+    rt_violation("aligned_alloc");
+    return real(alignment, size);
+}
+
+RT_CHECK_EXPORT void *mmap(void *address, size_t length, int protection, int flags, int fd, off_t offset)
+{
+    RT_REAL(mmap);
+    rt_violation("mmap");
+    return real(address, length, protection, flags, fd, offset);
+}
+
+RT_CHECK_EXPORT int munmap(void *address, size_t length)
+{
+    RT_REAL(munmap);
+    rt_violation("munmap");
+    return real(address, length);
+}
+
+RT_CHECK_EXPORT int mprotect(void *address, size_t length, int protection)
+{
+    RT_REAL(mprotect);
+    rt_violation("mprotect");
+    return real(address, length, protection);
+}
+
+RT_CHECK_EXPORT int mlock(const void *address, size_t length)
+{
+    RT_REAL(mlock);
+    rt_violation("mlock");
+    return real(address, length);
+}
+
+// --------------------------------------------------------------
+// locks
+
+RT_CHECK_EXPORT int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    RT_REAL(pthread_mutex_lock);
+    rt_violation("pthread_mutex_lock");
+    return real(mutex);
+}
+
+RT_CHECK_EXPORT int pthread_mutex_trylock(pthread_mutex_t *mutex)
+{
+    RT_REAL(pthread_mutex_trylock);
+    rt_violation("pthread_mutex_trylock");
+    return real(mutex);
+}
+
+RT_CHECK_EXPORT int pthread_mutex_unlock(pthread_mutex_t *mutex)
+{
+    RT_REAL(pthread_mutex_unlock);
+    rt_violation("pthread_mutex_unlock");
+    return real(mutex);
+}
+
+RT_CHECK_EXPORT int pthread_rwlock_rdlock(pthread_rwlock_t *lock)
+{
+    RT_REAL(pthread_rwlock_rdlock);
+    rt_violation("pthread_rwlock_rdlock");
+    return real(lock);
+}
+
+RT_CHECK_EXPORT int pthread_rwlock_wrlock(pthread_rwlock_t *lock)
+{
+    RT_REAL(pthread_rwlock_wrlock);
+    rt_violation("pthread_rwlock_wrlock");
+    return real(lock);
+}
+
+RT_CHECK_EXPORT int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+    RT_REAL(pthread_cond_wait);
+    rt_violation("pthread_cond_wait");
+    return real(cond, mutex);
+}
+
+RT_CHECK_EXPORT int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *time)
+{
+    RT_REAL(pthread_cond_timedwait);
+    rt_violation("pthread_cond_timedwait");
+    return real(cond, mutex, time);
+}
+
+RT_CHECK_EXPORT int pthread_cond_signal(pthread_cond_t *cond)
+{
+    RT_REAL(pthread_cond_signal);
+    rt_violation("pthread_cond_signal");
+    return real(cond);
+}
+
+RT_CHECK_EXPORT int pthread_cond_broadcast(pthread_cond_t *cond)
+{
+    RT_REAL(pthread_cond_broadcast);
+    rt_violation("pthread_cond_broadcast");
+    return real(cond);
+}
+
+RT_CHECK_EXPORT int sem_wait(sem_t *semaphore)
+{
+    RT_REAL(sem_wait);
+    rt_violation("sem_wait");
+    return real(semaphore);
+}
+
+// --------------------------------------------------------------
+// blocking calls
+
+RT_CHECK_EXPORT ssize_t read(int fd, void *buffer, size_t size)
+{
+    RT_REAL(read);
+    rt_violation("read");
+    return real(fd, buffer, size);
+}
+
+RT_CHECK_EXPORT ssize_t write(int fd, const void *buffer, size_t size)
+{
+    if (!real_write)
+        real_write = (ssize_t (*)(int, const void *, size_t))rt_resolve("write");
+    rt_violation("write");
+    return real_write(fd, buffer, size);
+}
+
+RT_CHECK_EXPORT int open(const char *path, int flags, ...)
+{
+    RT_REAL(open);
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE))
+    {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    rt_violation("open");
+    return real(path, flags, mode);
+}
+
+RT_CHECK_EXPORT int openat(int dirfd, const char *path, int flags, ...)
+{
+    RT_REAL(openat);
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE))
+    {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    rt_violation("openat");
+    return real(dirfd, path, flags, mode);
+}
+
+RT_CHECK_EXPORT int close(int fd)
+{
+    RT_REAL(close);
+    rt_violation("close");
+    return real(fd);
+}
+
+RT_CHECK_EXPORT int fsync(int fd)
+{
+    RT_REAL(fsync);
+    rt_violation("fsync");
+    return real(fd);
+}
+
+RT_CHECK_EXPORT FILE *fopen(const char *path, const char *mode)
+{
+    RT_REAL(fopen);
+    rt_violation("fopen");
+    return real(path, mode);
+}
+
+RT_CHECK_EXPORT int fclose(FILE *file)
+{
+    RT_REAL(fclose);
+    rt_violation("fclose");
+    return real(file);
+}
+
+RT_CHECK_EXPORT int fflush(FILE *file)
+{
+    RT_REAL(fflush);
+    rt_violation("fflush");
+    return real(file);
+}
+
+RT_CHECK_EXPORT size_t fwrite(const void *buffer, size_t size, size_t count, FILE *file)
+{
+    RT_REAL(fwrite);
+    rt_violation("fwrite");
+    return real(buffer, size, count, file);
+}
+
+RT_CHECK_EXPORT int puts(const char *text)
+{
+    RT_REAL(puts);
+    rt_violation("puts");
+    return real(text);
+}
+
+RT_CHECK_EXPORT int vfprintf(FILE *file, const char *format, va_list args)
+{
+    RT_REAL(vfprintf);
+    rt_violation("vfprintf");
+    return real(file, format, args);
+}
+
+RT_CHECK_EXPORT int fprintf(FILE *file, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    rt_violation("fprintf");
+    rt_reporting++;
+    const int result = vfprintf(file, format, args);
+    rt_reporting--;
+    va_end(args);
+    return result;
+}
+
+RT_CHECK_EXPORT int printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    rt_violation("printf");
+    rt_reporting++;
+    const int result = vfprintf(stdout, format, args);
+    rt_reporting--;
+    va_end(args);
+    return result;
+}
+
+RT_CHECK_EXPORT int nanosleep(const struct timespec *duration, struct timespec *remaining)
+{
+    RT_REAL(nanosleep);
+    rt_violation("nanosleep");
+    return real(duration, remaining);
+}
+
+RT_CHECK_EXPORT int clock_nanosleep(clockid_t clock, int flags, const struct timespec *duration, struct timespec *remaining)
+{
+    RT_REAL(clock_nanosleep);
+    rt_violation("clock_nanosleep");
+    return real(clock, flags, duration, remaining);
+}
+
+RT_CHECK_EXPORT int usleep(useconds_t duration)
+{
+    RT_REAL(usleep);
+    rt_violation("usleep");
+    return real(duration);
+}
+
+RT_CHECK_EXPORT unsigned int sleep(unsigned int seconds)
+{
+    RT_REAL(sleep);
+    rt_violation("sleep");
+    return real(seconds);
+}
+
+RT_CHECK_EXPORT int sched_yield(void)
+{
+    RT_REAL(sched_yield);
+    rt_violation("sched_yield");
+    return real();
+}
+
+RT_CHECK_EXPORT int poll(struct pollfd *fds, nfds_t count, int timeout)
+{
+    RT_REAL(poll);
+    rt_violation("poll");
+    return real(fds, count, timeout);
+}
+
+RT_CHECK_EXPORT int select(int count, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout)
+{
+    RT_REAL(select);
+    rt_violation("select");
+    return real(count, readfds, writefds, exceptfds, timeout);
+}
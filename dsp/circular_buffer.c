@@ -0,0 +1,413 @@
+/*
+  ==============================================================================
+
+ * VEJA NoiseGate
+ * Copyright (C) 2021 Jan Janssen <jan@moddevices.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#include "circular_buffer.h"
+#include "dsp_dispatch.h"
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// largest chunk the block detector handles in one pass
+#define RINGBUFFER_BLOCK_SIZE 64
+
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint32_t ringbuffer_v4u __attribute__((vector_size(16)));
+
+// shift the lanes of v up by 1 or 2, filling with the lanes of z
+#if defined(__clang__)
+#define RINGBUFFER_SHIFT1(z, v) __builtin_shufflevector(z, v, 0, 4, 5, 6)
+#define RINGBUFFER_SHIFT2(z, v) __builtin_shufflevector(z, v, 0, 1, 4, 5)
+#else
+#define RINGBUFFER_SHIFT1(z, v) __builtin_shuffle(z, v, (ringbuffer_v4u){ 0, 4, 5, 6 })
+#define RINGBUFFER_SHIFT2(z, v) __builtin_shuffle(z, v, (ringbuffer_v4u){ 0, 1, 4, 5 })
+#endif
+#endif
+
+static inline uint32_t ringbuffer_to_fixed(const float x)
+{
+    float v = fabsf(x) * RINGBUFFER_FIXED_SCALE;
+
+    if (!(v < RINGBUFFER_FIXED_MAX))
+        v = RINGBUFFER_FIXED_MAX;
+
+    //the clamped value always fits a signed int, which converts faster than unsigned
+    return (uint32_t)(int32_t)(v + 0.5f);
+}
+
+//inclusive prefix sum starting from sum, 4 lanes at a time. the integer sum is exact in any order
+static inline uint32_t ringbuffer_prefix_sum(uint32_t *x, const uint32_t n, uint32_t sum)
+{
+    uint32_t i = 0;
+
+#ifdef RINGBUFFER_SHIFT1
+    const ringbuffer_v4u zero = { 0, 0, 0, 0 };
+    ringbuffer_v4u carry = { sum, sum, sum, sum };
+
+    for (; i + 4 <= n; i += 4)
+    {
+        ringbuffer_v4u v;
+        memcpy(&v, x + i, sizeof(v));
+
+        v += RINGBUFFER_SHIFT1(zero, v);
+        v += RINGBUFFER_SHIFT2(zero, v);
+        v += carry;
+
+        memcpy(x + i, &v, sizeof(v));
+        carry = (ringbuffer_v4u){ v[3], v[3], v[3], v[3] };
+    }
+
+    sum = carry[0];
+#endif
+
+    for (; i < n; i++)
+    {
+        sum += x[i];
+        x[i] = sum;
+    }
+
+    return sum;
+}
+
+static inline uint32_t ringbuffer_clamp_size(const uint32_t size)
+{
+    if (size < 1)
+        return 1;
+    if (size > RINGBUFFER_MAX_SIZE)
+        return RINGBUFFER_MAX_SIZE;
+    return size;
+}
+
+size_t ringbuffer_memory_size(uint32_t size)
+{
+    return 2 * DSP_ARENA_SIZE(ringbuffer_clamp_size(size) * sizeof(uint32_t));
+}
+
+int ringbuffer_init(ringbuffer_t *buffer, uint32_t size, dsp_arena_t *arena)
+{
+    size = ringbuffer_clamp_size(size);
+
+    buffer->S = size;
+    buffer->m_scale = 1.0f / ((float)size * RINGBUFFER_FIXED_SCALE);
+    buffer->m_external = arena != NULL;
+    buffer->m_buffer = (uint32_t*)dsp_arena_calloc(arena, size, sizeof(uint32_t));
+    buffer->m_peak = (uint32_t*)dsp_arena_calloc(arena, size, sizeof(uint32_t));
+
+    if (buffer->m_buffer == NULL || buffer->m_peak == NULL)
+    {
+        ringbuffer_free(buffer);
+        return 0;
+    }
+
+    ringbuffer_clear(buffer);
+    return 1;
+}
+
+void ringbuffer_free(ringbuffer_t *buffer)
+{
+    dsp_arena_release(buffer->m_buffer, buffer->m_external);
+    dsp_arena_release(buffer->m_peak, buffer->m_external);
+    buffer->m_buffer = NULL;
+    buffer->m_peak = NULL;
+}
+
+void ringbuffer_clear(ringbuffer_t *buffer)
+{
+    memset(buffer->m_buffer, 0, buffer->S * sizeof(uint32_t));
+
+    buffer->m_size = 0;
+    buffer->m_front = 0;
+    buffer->m_back  = buffer->S - 1;
+    buffer->power = 0;
+    buffer->m_peak_front = 0;
+    buffer->m_peak_size = 0;
+}
+
+void ringbuffer_push(ringbuffer_t *buffer)
+{
+    buffer->m_back = (buffer->m_back + 1) % buffer->S;
+
+    if(buffer->m_size == buffer->S)
+    {
+        buffer->m_front = (buffer->m_front + 1) % buffer->S;
+    }
+    else
+    {
+        buffer->m_size++;
+    }
+}
+    
+void ringbuffer_push_sample(ringbuffer_t *buffer, const float x)
+{
+    ringbuffer_push(buffer);
+    buffer->m_buffer[buffer->m_back] = ringbuffer_to_fixed(x);
+}
+    
+void ringbuffer_pop(ringbuffer_t *buffer)
+{
+    if(buffer->m_size > 0 ) 
+    {
+        buffer->m_size--;
+        buffer->m_front = (buffer->m_front + 1) % buffer->S;
+    }
+}
+    
+void ringbuffer_back_erase(ringbuffer_t *buffer, const uint32_t n)
+{
+    if(n >= buffer->m_size)
+    {
+        ringbuffer_clear(buffer);
+    }
+    else 
+    {
+        buffer->m_size -= n;
+        buffer->m_back = (buffer->m_front + buffer->m_size - 1) % buffer->S;
+    }
+}
+    
+void ringbuffer_front_erase(ringbuffer_t *buffer, const uint32_t n)
+{
+    if(n >= buffer->m_size)
+    {
+        ringbuffer_clear(buffer);
+    }
+    else 
+    {
+        buffer->m_size -= n;
+        buffer->m_front = (buffer->m_front + n) % buffer->S;
+    }
+}
+
+float ringbuffer_push_and_calculate_power(ringbuffer_t *buffer, const float input)
+{
+    const uint32_t pow = ringbuffer_to_fixed(input);
+
+    if (buffer->m_size < buffer->S)
+    {
+        //add new sample to windowPower
+        buffer->power += pow;
+    }
+    else
+    {
+        //remove old sample and add new one to windowPower
+        buffer->power += pow - buffer->m_buffer[buffer->m_front];
+        ringbuffer_pop(buffer);
+    }
+
+    ringbuffer_push(buffer);
+    buffer->m_buffer[buffer->m_back] = pow;
+
+    //windowPower holds the sum of |x|, scale it back to the window mean
+    return (float)buffer->power * buffer->m_scale;
+}
+
+DSP_KERNEL
+void ringbuffer_push_and_calculate_power_block(ringbuffer_t *buffer, const float *input, float *power, uint32_t n)
+{
+    uint32_t added[RINGBUFFER_BLOCK_SIZE];
+    uint32_t removed[RINGBUFFER_BLOCK_SIZE];
+
+    while (n > 0)
+    {
+        //keep each pass within one window, so every removed sample is already in the buffer
+        uint32_t len = (n < RINGBUFFER_BLOCK_SIZE) ? n : RINGBUFFER_BLOCK_SIZE;
+        if (len > buffer->S)
+            len = buffer->S;
+
+        //slots after m_back hold the samples leaving the window, or zeros while it fills up
+        uint32_t start = buffer->m_back + 1;
+        if (start == buffer->S)
+            start = 0;
+
+        const uint32_t first = (buffer->S - start < len) ? buffer->S - start : len;
+
+        memcpy(removed, buffer->m_buffer + start, first * sizeof(uint32_t));
+        memcpy(removed + first, buffer->m_buffer, (len - first) * sizeof(uint32_t));
+
+        for (uint32_t i = 0; i < len; i++)
+            added[i] = ringbuffer_to_fixed(input[i]);
+
+        memcpy(buffer->m_buffer + start, added, first * sizeof(uint32_t));
+        memcpy(buffer->m_buffer, added + first, (len - first) * sizeof(uint32_t));
+
+        //moving sum as prefix sum of the added minus the removed samples
+        for (uint32_t i = 0; i < len; i++)
+            removed[i] = added[i] - removed[i];
+
+        buffer->power = ringbuffer_prefix_sum(removed, len, buffer->power);
+
+        for (uint32_t i = 0; i < len; i++)
+            power[i] = (float)removed[i] * buffer->m_scale;
+
+        buffer->m_back = (start + len - 1) % buffer->S;
+        buffer->m_size = (buffer->m_size + len < buffer->S) ? buffer->m_size + len : buffer->S;
+        buffer->m_front = (buffer->m_size == buffer->S) ? (buffer->m_back + 1) % buffer->S : 0;
+
+        input += len;
+        power += len;
+        n -= len;
+    }
+}
+
+float ringbuffer_push_and_calculate_peak(ringbuffer_t *buffer, const float input)
+{
+    const uint32_t peak = ringbuffer_to_fixed(input);
+
+    if (buffer->m_size == buffer->S)
+    {
+        //the oldest sample leaves the window, drop it from the deque if it was the maximum
+        if (buffer->m_peak_size > 0 && buffer->m_peak[buffer->m_peak_front] == buffer->m_front)
+        {
+            buffer->m_peak_size--;
+            if (++buffer->m_peak_front == buffer->S)
+                buffer->m_peak_front = 0;
+        }
+
+        ringbuffer_pop(buffer);
+    }
+
+    ringbuffer_push(buffer);
+    buffer->m_buffer[buffer->m_back] = peak;
+
+    //samples smaller than the new one can never become the maximum again
+    while (buffer->m_peak_size > 0)
+    {
+        uint32_t last = buffer->m_peak_front + buffer->m_peak_size - 1;
+        if (last >= buffer->S)
+            last -= buffer->S;
+
+        if (buffer->m_buffer[buffer->m_peak[last]] > peak)
+            break;
+
+        buffer->m_peak_size--;
+    }
+
+    uint32_t next = buffer->m_peak_front + buffer->m_peak_size;
+    if (next >= buffer->S)
+        next -= buffer->S;
+
+    buffer->m_peak[next] = buffer->m_back;
+    buffer->m_peak_size++;
+
+    return (float)buffer->m_buffer[buffer->m_peak[buffer->m_peak_front]] * (1.0f / RINGBUFFER_FIXED_SCALE);
+}
+
+float ringbuffer_front(ringbuffer_t *buffer)
+{ 
+	return (float)buffer->m_buffer[buffer->m_front] * (1.0f / RINGBUFFER_FIXED_SCALE);
+}
+
+float ringbuffer_back(ringbuffer_t *buffer)
+{ 
+	return (float)buffer->m_buffer[buffer->m_back] * (1.0f / RINGBUFFER_FIXED_SCALE);
+}
+
+float ringbuffer_get_val(ringbuffer_t *buffer, uint32_t index)
+{ 
+	return (float)buffer->m_buffer[index] * (1.0f / RINGBUFFER_FIXED_SCALE);
+}
+
+int ringbuffer_empty(ringbuffer_t *buffer)
+{ 
+	return buffer->m_size == 0; 
+}
+
+int ringbuffer_full(ringbuffer_t *buffer)
+{ 
+	return buffer->m_size == buffer->S; 
+}
+
+uint32_t * ringbuffer_get_first_pointer(ringbuffer_t *buffer)
+{
+    return &buffer->m_buffer[buffer->m_back];
+}
+
+size_t delayline_memory_size(uint32_t size)
+{
+    return DSP_ARENA_SIZE(((size < 1) ? 1 : size) * sizeof(float));
+}
+
+//no previous delay to fade from, the first one after init or clear is taken as it is
+#define DELAYLINE_NO_DELAY UINT32_MAX
+
+int delayline_init(delayline_t *line, uint32_t size, dsp_arena_t *arena)
+{
+    line->S = (size < 1) ? 1 : size;
+    line->m_pos = 0;
+    line->m_delay = DELAYLINE_NO_DELAY;
+    line->m_from = 0;
+    line->m_fade = 0;
+    line->m_fadeLength = 0;
+    line->m_fadeInv = 0.0f;
+    line->m_external = arena != NULL;
+    line->m_buffer = (float*)dsp_arena_calloc(arena, line->S, sizeof(float));
+
+    return line->m_buffer != NULL;
+}
+
+void delayline_free(delayline_t *line)
+{
+    dsp_arena_release(line->m_buffer, line->m_external);
+    line->m_buffer = NULL;
+}
+
+void delayline_clear(delayline_t *line)
+{
+    memset(line->m_buffer, 0, line->S * sizeof(float));
+    line->m_pos = 0;
+    line->m_delay = DELAYLINE_NO_DELAY;
+    line->m_fade = 0;
+}
+
+void delayline_set_fade(delayline_t *line, uint32_t length)
+{
+    line->m_fadeLength = length;
+    line->m_fadeInv = (length > 0) ? 1.0f / length : 0.0f;
+}
+
+float delayline_process(delayline_t *line, const float input, const uint32_t delay)
+{
+    //moving the read position in one step would click, the new delay fades in over the old one
+    if (delay != line->m_delay)
+    {
+        line->m_fade = (line->m_delay != DELAYLINE_NO_DELAY) ? line->m_fadeLength : 0;
+        line->m_from = line->m_delay;
+        line->m_delay = delay;
+    }
+
+    //delay must be smaller than the line size
+    const uint32_t read = (line->m_pos >= delay) ? line->m_pos - delay : line->m_pos + line->S - delay;
+
+    line->m_buffer[line->m_pos] = input;
+    float output = line->m_buffer[read];
+
+    if (line->m_fade > 0)
+    {
+        const uint32_t from = (line->m_pos >= line->m_from) ? line->m_pos - line->m_from
+                                                             : line->m_pos + line->S - line->m_from;
+        output += (line->m_buffer[from] - output) * ((float)line->m_fade * line->m_fadeInv);
+        line->m_fade--;
+    }
+
+    if (++line->m_pos == line->S)
+        line->m_pos = 0;
+
+    return output;
+}
\ No newline at end of file
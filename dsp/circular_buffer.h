@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+ * VEJA NoiseGate
+ * Copyright (C) 2021 Jan Janssen <jan@moddevices.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#ifndef CIRCULAR_BUFFER_H
+#define CIRCULAR_BUFFER_H
+
+#include <stdint.h>
+#include "dsp_arena.h"
+
+// upper bound for the window length, the buffer itself is sized at init
+#define RINGBUFFER_MAX_SIZE 4096
+
+// samples are stored as unsigned fixed point with 18 fractional bits, so the running sum
+// is exact and never drifts. |x| is clamped just below 4.0 (+12dBFS), which keeps the sum
+// of a full RINGBUFFER_MAX_SIZE window inside 32 bits
+#define RINGBUFFER_FIXED_SCALE 262144.0f
+#define RINGBUFFER_FIXED_MAX   1048575.0f
+
+typedef struct RINGBUFFER_T {
+	uint32_t S;
+	uint32_t *m_buffer;
+	uint32_t m_size;
+	uint32_t m_front;
+	uint32_t m_back;
+	uint32_t power;
+	float m_scale;
+	// monotonic deque of buffer indices for the sliding window maximum
+	uint32_t *m_peak;
+	uint32_t m_peak_front;
+	uint32_t m_peak_size;
+	int m_external; // the memory belongs to an arena
+} ringbuffer_t;
+
+// plain audio delay line, used to run the gate detector ahead of the audio
+typedef struct DELAYLINE_T {
+	uint32_t S;
+	float *m_buffer;
+	uint32_t m_pos;
+	// a changed delay fades in over the previous one, see delayline_set_fade
+	uint32_t m_delay, m_from, m_fade, m_fadeLength;
+	float m_fadeInv;
+	int m_external;
+} delayline_t;
+
+// arena may be NULL to allocate from the heap, the memory_size functions return what init takes from an arena
+int ringbuffer_init(ringbuffer_t *buffer, uint32_t size, dsp_arena_t *arena);
+size_t ringbuffer_memory_size(uint32_t size);
+void ringbuffer_free(ringbuffer_t *buffer);
+void ringbuffer_clear(ringbuffer_t *buffer);
+void ringbuffer_push(ringbuffer_t *buffer);
+void ringbuffer_push_sample(ringbuffer_t *buffer, const float x);
+void ringbuffer_pop(ringbuffer_t *buffer);
+void ringbuffer_back_erase(ringbuffer_t *buffer, const uint32_t n);
+void ringbuffer_front_erase(ringbuffer_t *buffer, const uint32_t n);
+float ringbuffer_push_and_calculate_power(ringbuffer_t *buffer, const float input);
+float ringbuffer_push_and_calculate_peak(ringbuffer_t *buffer, const float input);
+void ringbuffer_push_and_calculate_power_block(ringbuffer_t *buffer, const float *input, float *power, uint32_t n);
+float ringbuffer_front(ringbuffer_t *buffer);
+float ringbuffer_back(ringbuffer_t *buffer);
+float ringbuffer_get_val(ringbuffer_t *buffer, uint32_t index);
+int ringbuffer_empty(ringbuffer_t *buffer);
+int ringbuffer_full(ringbuffer_t *buffer);
+uint32_t * ringbuffer_get_first_pointer(ringbuffer_t *buffer);
+
+int delayline_init(delayline_t *line, uint32_t size, dsp_arena_t *arena);
+size_t delayline_memory_size(uint32_t size);
+void delayline_free(delayline_t *line);
+void delayline_clear(delayline_t *line);
+void delayline_set_fade(delayline_t *line, uint32_t length);
+float delayline_process(delayline_t *line, const float input, const uint32_t delay);
+
+#endif // __RINGBUFFER_H__
@@ -19,6 +19,8 @@
 */
 
 #include "compressor_core.h"
+#include "dsp_dispatch.h"
+#include "dsp_tables.h"
 #include <math.h>
 #include <string.h>
 
@@ -36,15 +38,16 @@ static inline float kneeslope(float x, float k, float linearthreshold){
 	return k * x / ((k * linearthreshold + 1.0f) * expf(k * (x - linearthreshold)) - 1);
 }
 
+// runs per sample, so it uses the tables in dsp_tables.h, x is never below linearthreshold there
 static inline float compcurve(float x, float k, float slope, float linearthreshold,
 	float linearthresholdknee, float threshold, float knee, float kneedboffset){
 	if (x < linearthreshold)
 		return x;
 	if (knee <= 0.0f) // no knee in curve
-		return cmop_db2lin(threshold + slope * (lin2db(x) - threshold));
+		return dsp_db2lin(threshold + slope * (dsp_lin2db(x) - threshold));
 	if (x < linearthresholdknee)
 		return kneecurve(x, k, linearthreshold);
-	return cmop_db2lin(kneedboffset + slope * (lin2db(x) - threshold - knee));
+	return dsp_db2lin(kneedboffset + slope * (dsp_lin2db(x) - threshold - knee));
 }
 
 // for more information on the adaptive release curve, check out adaptive-release-curve.html demo +
@@ -86,6 +89,12 @@ void compressor_init(sf_compressor_state_st *state, int samplerate)
 
 	state->ang90 = (float)M_PI * 0.5f;
 	state->ang90inv = 2.0f / (float)M_PI;
+
+	dsp_telemetry_init(&state->telemetry);
+
+#ifdef DSP_STATS
+	state->stats = NULL;
+#endif
 }
 
 // this is the main initialization function
@@ -93,6 +102,8 @@ void compressor_init(sf_compressor_state_st *state, int samplerate)
 void compressor_set_params(sf_compressor_state_st *state, float threshold,
 	float knee, float ratio, float attack, float release, float makeup){
 
+	DSP_STATS_COUNT(state->stats, set_params);
+
 	// useful values
 	float linearthreshold = cmop_db2lin(threshold);
 	float slope = 1.0f / ratio;
@@ -156,6 +167,7 @@ void compressor_set_params(sf_compressor_state_st *state, float threshold,
 	state->d                    = d;
 }
 
+DSP_KERNEL
 void compressor_process(sf_compressor_state_st *state, int size, const float *input_L, const float *input_R, float *output_L, float *output_R)
 {
 	// pull out the state into local variables
@@ -176,6 +188,8 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 	float detectoravg          = state->detectoravg;
 	float compgain             = state->compgain;
 	float maxcompdiffdb        = state->maxcompdiffdb;
+	dsp_telemetry_values_t *telemetry = &state->telemetry.current;
+	float reduction            = telemetry->gain_last;
 
 	int chunks = size > SF_COMPRESSOR_SPU ? size / SF_COMPRESSOR_SPU : 1;
 	int spu = size > SF_COMPRESSOR_SPU ? SF_COMPRESSOR_SPU : size;
@@ -208,6 +222,11 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 			enveloperate = 1.0f - powf(0.25f / attenuate, attacksamplesinv);
 		}
 
+#ifdef DSP_STATS
+		const int chunkstart = samplepos;
+		int fastsamples = 0;
+#endif
+
 		// process the chunk
 		for (int chi = 0; chi < spu && samplepos < size; chi++, samplepos++)
 		{
@@ -217,6 +236,9 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 			if (inputmax < 0.0001f)
 			{
 				attenuation = 1.0f;
+#ifdef DSP_STATS
+				fastsamples++;
+#endif
 			}
 			else
 			{
@@ -228,11 +250,11 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 			float rate;
 			if (attenuation > detectoravg)
 			{ // if releasing
-				float attenuationdb = -lin2db(attenuation);
+				float attenuationdb = -dsp_lin2db(attenuation);
 				if (attenuationdb < 2.0f)
 					attenuationdb = 2.0f;
 				float dbpersample = attenuationdb * satreleasesamplesinv;
-				rate = cmop_db2lin(dbpersample) - 1.0f;
+				rate = dsp_db2lin(dbpersample) - 1.0f;
 			}
 			else
 				rate = 1.0f;
@@ -253,15 +275,33 @@ void compressor_process(sf_compressor_state_st *state, int size, const float *in
 					compgain = 1.0f;
 			}
 
-			const float gain = mastergain * sinf(state->ang90 * compgain);
+			reduction = dsp_sine_gain(compgain);
+			const float gain = mastergain * reduction;
 
 			// apply the gain
 			output_L[samplepos] = input_L[samplepos] * gain;
 			output_R[samplepos] = input_R[samplepos] * gain;
 		}
+
+		// telemetry, once per chunk
+		if (reduction < telemetry->gain_min)
+			telemetry->gain_min = reduction;
+		telemetry->gain_sum += reduction;
+		telemetry->gain_chunks++;
+
+#ifdef DSP_STATS
+		if (state->stats)
+		{
+			if (fastsamples == samplepos - chunkstart)
+				state->stats->counters.chunks_fast++;
+			else
+				state->stats->counters.chunks_full++;
+		}
+#endif
 	}
 
 	state->detectoravg   = detectoravg;
 	state->compgain      = compgain;
 	state->maxcompdiffdb = maxcompdiffdb;
+	telemetry->gain_last = reduction;
 }
@@ -21,6 +21,9 @@
 #ifndef COMPRESSOR_CORE__H
 #define COMPRESSOR_CORE__H
 
+#include "dsp_stats.h"
+#include "dsp_telemetry.h"
+
 // samples per update; the compressor works by dividing the input chunks into even smaller sizes,
 // and performs heavier calculations after each mini-chunk to adjust the final envelope
 #define SF_COMPRESSOR_SPU        32
@@ -47,6 +50,10 @@ typedef struct {
 	float samplerate;
 	float ang90;
 	float ang90inv;
+	dsp_telemetry_t telemetry; // gain reduction per chunk, published by the plugin
+#ifdef DSP_STATS
+	dsp_stats_t *stats; // hot path counters, NULL unless the plugin opened them
+#endif
 } sf_compressor_state_st;
 
 float cmop_db2lin(float db);
@@ -0,0 +1,115 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "dsp_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#elif defined(DSP_ARENA_MLOCK)
+#include <sys/mman.h>
+#endif
+
+int dsp_arena_init(dsp_arena_t *arena, const size_t size)
+{
+    void *base = NULL;
+
+    arena->size = DSP_ARENA_SIZE(size);
+    arena->used = 0;
+    arena->locked = 0;
+
+    //there is no posix_memalign on Windows, its aligned blocks need _aligned_free
+#ifdef _WIN32
+    base = _aligned_malloc(arena->size, DSP_CACHE_LINE);
+    if (base == NULL)
+#else
+    if (posix_memalign(&base, DSP_CACHE_LINE, arena->size) != 0)
+#endif
+    {
+        arena->base = NULL;
+        return 0;
+    }
+
+    //writing every page now is what keeps the page faults out of run()
+    arena->base = (uint8_t *)base;
+    memset(arena->base, 0, arena->size);
+
+#if defined(DSP_ARENA_MLOCK) && !defined(_WIN32)
+    //usually limited by RLIMIT_MEMLOCK, the arena works the same without it
+    arena->locked = mlock(arena->base, arena->size) == 0;
+#endif
+
+    return 1;
+}
+
+void dsp_arena_attach(dsp_arena_t *arena, void *memory, const size_t size)
+{
+    const uintptr_t start = ((uintptr_t)memory + DSP_CACHE_LINE - 1) & ~(uintptr_t)(DSP_CACHE_LINE - 1);
+    const uintptr_t end = (uintptr_t)memory + size;
+
+    arena->base = (uint8_t *)start;
+    arena->size = (end > start) ? (size_t)(end - start) & ~(size_t)(DSP_CACHE_LINE - 1) : 0;
+    arena->used = 0;
+    arena->locked = 0;
+
+    memset(arena->base, 0, arena->size);
+}
+
+void dsp_arena_free(dsp_arena_t *arena)
+{
+    //the arena struct itself may live inside the block, so copy it out first
+    const dsp_arena_t copy = *arena;
+
+#if defined(DSP_ARENA_MLOCK) && !defined(_WIN32)
+    if (copy.locked)
+        munlock(copy.base, copy.size);
+#endif
+
+#ifdef _WIN32
+    _aligned_free(copy.base);
+#else
+    free(copy.base);
+#endif
+}
+
+void *dsp_arena_alloc(dsp_arena_t *arena, const size_t size)
+{
+    const size_t bytes = DSP_ARENA_SIZE(size);
+
+    if (arena->base == NULL || bytes > arena->size - arena->used)
+        return NULL;
+
+    void *memory = arena->base + arena->used;
+    arena->used += bytes;
+
+    return memory;
+}
+
+void *dsp_arena_calloc(dsp_arena_t *arena, const size_t count, const size_t size)
+{
+    if (arena)
+        return dsp_arena_alloc(arena, count * size);
+
+    return calloc(count, size);
+}
+
+void dsp_arena_release(void *memory, const int external)
+{
+    if (!external)
+        free(memory);
+}
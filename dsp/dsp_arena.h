@@ -0,0 +1,67 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_ARENA_H_INCLUDED
+#define DSP_ARENA_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per instance memory. instantiate() sizes one block for the plugin struct and every buffer of
+// the cores, the arena hands it out in cache line aligned pieces. All of it is written once at
+// init, so the first run() after loading a pedalboard does not page fault, and with MLOCK=true
+// (DSP_ARENA_MLOCK) it is also locked in RAM. Nothing is freed on its own, the whole block goes
+// at cleanup.
+
+#define DSP_CACHE_LINE 64
+#define DSP_CACHE_ALIGNED __attribute__((aligned(DSP_CACHE_LINE)))
+
+// bytes an allocation takes from the arena
+#define DSP_ARENA_SIZE(bytes) (((size_t)(bytes) + DSP_CACHE_LINE - 1) & ~(size_t)(DSP_CACHE_LINE - 1))
+
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    int locked;
+} dsp_arena_t;
+
+/// <summary>This method called from instantiate to allocate, prefault and optionally lock the arena</summary>
+/// <param name="size">Holds the total of the DSP_ARENA_SIZE of every allocation</param>
+/// <returns>0 if the memory could not be allocated, a failed mlock is not an error</returns>
+int dsp_arena_init(dsp_arena_t *arena, const size_t size);
+
+/// <summary>This method called to hand out a block the caller owns, it is zeroed but neither allocated nor locked</summary>
+/// <param name="memory">Holds the block, it is aligned up to DSP_CACHE_LINE so it needs that much more than the allocations</param>
+/// <param name="size">Holds the size of the block in bytes</param>
+void dsp_arena_attach(dsp_arena_t *arena, void *memory, const size_t size);
+
+/// <summary>This method called from cleanup to release the arena and everything allocated from it</summary>
+void dsp_arena_free(dsp_arena_t *arena);
+
+/// <summary>This method called to take zeroed and cache line aligned memory from the arena</summary>
+/// <returns>NULL if the arena is exhausted</returns>
+void *dsp_arena_alloc(dsp_arena_t *arena, const size_t size);
+
+/// <summary>This method called by the cores to allocate from an arena, or from the heap when there is none</summary>
+/// <param name="arena">Holds the arena, or NULL for calloc</param>
+void *dsp_arena_calloc(dsp_arena_t *arena, const size_t count, const size_t size);
+
+/// <summary>This method called to release memory from dsp_arena_calloc, only heap memory is freed</summary>
+/// <param name="external">Holds 1 if the memory came from an arena</param>
+void dsp_arena_release(void *memory, const int external);
+
+#endif //DSP_ARENA_H_INCLUDED
@@ -0,0 +1,84 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_DENORMAL_H_INCLUDED
+#define DSP_DENORMAL_H_INCLUDED
+
+#include <stdint.h>
+
+// Scoped flush-to-zero for run(). Denormal operands, e.g. the input of a plugin at the end of a
+// reverb or delay tail, make every multiply on them take a slow microcode path on x86 and on
+// cores without a flushing FPU. The plugins switch the FPU to flush them to zero for the
+// duration of run() and put the host's mode back before they return:
+//   x86     MXCSR FTZ and DAZ, SSE only, the x87 unit is not used for float code on x86_64
+//   aarch64 FPCR.FZ, which flushes inputs and results
+//   arm     FPSCR.FZ of VFP, NEON always flushes
+// Defining DSP_NO_FTZ compiles the guard out, to measure the difference.
+
+#if !defined(DSP_NO_FTZ) && (defined(__SSE__) || defined(__x86_64__))
+#include <xmmintrin.h>
+#define DSP_FTZ_MASK 0x8040u   // FTZ | DAZ
+#elif !defined(DSP_NO_FTZ) && (defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP)))
+#define DSP_FTZ_MASK (1u << 24) // FZ
+#endif
+
+typedef uint32_t dsp_fpmode_t;
+
+/// <summary>This method called at the start of run() to flush denormals to zero</summary>
+/// <returns>The floating point mode of the host, for dsp_denormals_restore</returns>
+static inline dsp_fpmode_t dsp_denormals_disable(void)
+{
+#if defined(DSP_FTZ_MASK) && (defined(__SSE__) || defined(__x86_64__))
+    const dsp_fpmode_t mode = _mm_getcsr();
+    if ((mode & DSP_FTZ_MASK) != DSP_FTZ_MASK)
+        _mm_setcsr(mode | DSP_FTZ_MASK);
+    return mode;
+#elif defined(DSP_FTZ_MASK) && defined(__aarch64__)
+    uint64_t mode;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(mode));
+    if (!(mode & DSP_FTZ_MASK))
+        __asm__ volatile("msr fpcr, %0" : : "r"(mode | DSP_FTZ_MASK));
+    return (dsp_fpmode_t)mode;
+#elif defined(DSP_FTZ_MASK)
+    uint32_t mode;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(mode));
+    if (!(mode & DSP_FTZ_MASK))
+        __asm__ volatile("vmsr fpscr, %0" : : "r"(mode | DSP_FTZ_MASK));
+    return mode;
+#else
+    return 0;
+#endif
+}
+
+/// <summary>This method called at the end of run() to give the host its floating point mode back</summary>
+/// <param name="mode">Holds the value returned by dsp_denormals_disable</param>
+static inline void dsp_denormals_restore(const dsp_fpmode_t mode)
+{
+#if defined(DSP_FTZ_MASK) && (defined(__SSE__) || defined(__x86_64__))
+    if ((mode & DSP_FTZ_MASK) != DSP_FTZ_MASK)
+        _mm_setcsr(mode);
+#elif defined(DSP_FTZ_MASK) && defined(__aarch64__)
+    if (!(mode & DSP_FTZ_MASK))
+        __asm__ volatile("msr fpcr, %0" : : "r"((uint64_t)mode));
+#elif defined(DSP_FTZ_MASK)
+    if (!(mode & DSP_FTZ_MASK))
+        __asm__ volatile("vmsr fpscr, %0" : : "r"(mode));
+#else
+    (void)mode;
+#endif
+}
+
+#endif //DSP_DENORMAL_H_INCLUDED
@@ -0,0 +1,32 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_DISPATCH_H_INCLUDED
+#define DSP_DISPATCH_H_INCLUDED
+
+// DSP_KERNEL marks the hot kernels. On x86_64 Linux they are compiled for several instruction
+// sets and the loader picks the best one for the host CPU through an ifunc. FMA is left out on
+// purpose so every variant produces the same output.
+// aarch64 always has ASIMD, and Makefile.mk passes -mfpu=neon to 32-bit ARM builds, so the
+// baseline build is already the vector one there.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(DSP_NO_DISPATCH) && \
+    (!defined(__clang__) || __clang_major__ >= 14)
+#define DSP_KERNEL __attribute__((target_clones("default", "sse4.1", "avx2")))
+#else
+#define DSP_KERNEL
+#endif
+
+#endif //DSP_DISPATCH_H_INCLUDED
@@ -0,0 +1,210 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "dsp_stats.h"
+
+#ifdef DSP_STATS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+//shared by every instance of the plugin binary, each binary maps the table on its own
+//and unmaps it again once its last instance is gone, so it never holds on to an unlinked table
+static dsp_stats_shm_t *dsp_stats_shm = NULL;
+static uint32_t dsp_stats_local_users = 0;
+
+uint64_t dsp_stats_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+//runs once per process when the table is created, outside of run()
+static uint64_t dsp_stats_tick_rate(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    struct timespec t0, t1, pause = { 0, 10000000 };
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    const uint64_t start = dsp_stats_ticks();
+    nanosleep(&pause, NULL);
+    const uint64_t ticks = dsp_stats_ticks() - start;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    const double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    return (uint64_t)(ticks / seconds);
+#elif defined(__aarch64__)
+    uint64_t rate;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(rate));
+    return rate;
+#else
+    return 1000000000ull;
+#endif
+}
+
+static dsp_stats_shm_t *dsp_stats_map(void)
+{
+    char name[64];
+
+    if (dsp_stats_shm)
+        return dsp_stats_shm;
+
+    snprintf(name, sizeof(name), DSP_STATS_SHM_PREFIX "%d", (int)getpid());
+
+    const int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return NULL;
+
+    //the table has a fixed size, a second binary truncating it again changes nothing
+    if (ftruncate(fd, sizeof(dsp_stats_shm_t)) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *table = mmap(NULL, sizeof(dsp_stats_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (table == MAP_FAILED)
+        return NULL;
+
+    dsp_stats_shm = (dsp_stats_shm_t *)table;
+
+    if (__atomic_load_n(&dsp_stats_shm->magic, __ATOMIC_ACQUIRE) != DSP_STATS_MAGIC)
+    {
+        dsp_stats_shm->version = DSP_STATS_VERSION;
+        dsp_stats_shm->slots = DSP_STATS_MAX_SLOTS;
+        dsp_stats_shm->tick_rate = dsp_stats_tick_rate();
+        __atomic_store_n(&dsp_stats_shm->magic, DSP_STATS_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    return dsp_stats_shm;
+}
+
+dsp_stats_t *dsp_stats_open(const char *uri, const uint32_t sampleRate)
+{
+    dsp_stats_shm_t *table = dsp_stats_map();
+
+    if (!table)
+        return NULL;
+
+    dsp_stats_t *stats = (dsp_stats_t *)calloc(1, sizeof(dsp_stats_t));
+    if (!stats)
+        return NULL;
+
+    for (uint32_t i = 0; i < DSP_STATS_MAX_SLOTS; i++)
+    {
+        uint32_t expected = 0;
+
+        if (__atomic_compare_exchange_n(&table->slot[i].in_use, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            stats->slot = &table->slot[i];
+            break;
+        }
+    }
+
+    if (!stats->slot)
+    {
+        free(stats);
+        return NULL;
+    }
+
+    memset(&stats->slot->counters, 0, sizeof(stats->slot->counters));
+    snprintf(stats->slot->uri, sizeof(stats->slot->uri), "%s", uri);
+    __atomic_add_fetch(&table->users, 1, __ATOMIC_ACQ_REL);
+    __atomic_add_fetch(&dsp_stats_local_users, 1, __ATOMIC_ACQ_REL);
+
+    stats->period = sampleRate * DSP_STATS_PERIOD_MS / 1000;
+    stats->countdown = stats->period;
+
+    return stats;
+}
+
+void dsp_stats_close(dsp_stats_t *stats)
+{
+    char name[64];
+
+    if (!stats)
+        return;
+
+    __atomic_store_n(&stats->slot->in_use, 0, __ATOMIC_RELEASE);
+    free(stats);
+
+    //the last instance in the process removes the table
+    if (__atomic_sub_fetch(&dsp_stats_shm->users, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        snprintf(name, sizeof(name), DSP_STATS_SHM_PREFIX "%d", (int)getpid());
+        shm_unlink(name);
+    }
+
+    //the next instance of this binary maps whichever table is current then, a new one after the unlink
+    if (__atomic_sub_fetch(&dsp_stats_local_users, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        munmap(dsp_stats_shm, sizeof(dsp_stats_shm_t));
+        dsp_stats_shm = NULL;
+    }
+}
+
+static void dsp_stats_publish(dsp_stats_t *stats)
+{
+    dsp_stats_slot_t *slot = stats->slot;
+    const uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->counters, &stats->counters, sizeof(stats->counters));
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+void dsp_stats_run_end(dsp_stats_t *stats, const uint64_t start, const uint32_t n_samples)
+{
+    const uint64_t ticks = dsp_stats_ticks() - start;
+    dsp_stats_counters_t *counters = &stats->counters;
+
+    counters->runs++;
+    counters->samples += n_samples;
+    counters->run_ticks += ticks;
+    if (ticks > counters->run_ticks_max)
+        counters->run_ticks_max = ticks;
+
+    if (n_samples < stats->countdown)
+    {
+        stats->countdown -= n_samples;
+        return;
+    }
+
+    stats->countdown = stats->period;
+    dsp_stats_publish(stats);
+}
+
+#else
+
+//keeps the translation unit from being empty when the counters are compiled out
+typedef int dsp_stats_disabled_t;
+
+#endif
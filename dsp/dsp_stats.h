@@ -0,0 +1,98 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_STATS_H_INCLUDED
+#define DSP_STATS_H_INCLUDED
+
+#include <stdint.h>
+
+// Hot path counters, only compiled in with DSP_STATS (STATS=true in Makefile.mk).
+// Every instance counts into a private block from run() and copies it every
+// DSP_STATS_PERIOD_MS into its slot of a per process shared memory table, guarded by a
+// sequence lock so a non real-time reader (tools/dsp-stats) never blocks the audio thread.
+// Without DSP_STATS the macros below compile to nothing.
+
+#define DSP_STATS_SHM_PREFIX "/mod-system-plugins-stats."
+#define DSP_STATS_MAGIC 0x4d4f4453u
+#define DSP_STATS_VERSION 1
+#define DSP_STATS_MAX_SLOTS 64
+#define DSP_STATS_URI_SIZE 128
+#define DSP_STATS_PERIOD_MS 100
+
+typedef struct {
+    uint64_t runs;
+    uint64_t samples;
+    uint64_t run_ticks;             // summed over all runs, see dsp_stats_shm_t.tick_rate
+    uint64_t run_ticks_max;
+    uint64_t set_params;            // compressor_set_params calls
+    uint64_t chunks_fast;           // compressor chunks where every sample was below the detector floor
+    uint64_t chunks_full;
+    uint64_t gate_steps[3];         // state machine steps spent in IDLE, HOLD and DECAY
+    uint64_t gate_transitions;
+} dsp_stats_counters_t;
+
+typedef struct {
+    uint32_t in_use;
+    uint32_t sequence;              // odd while the owner is writing
+    char uri[DSP_STATS_URI_SIZE];
+    dsp_stats_counters_t counters;
+} dsp_stats_slot_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t users;
+    uint32_t slots;
+    uint64_t tick_rate;             // ticks per second of the run timing
+    dsp_stats_slot_t slot[DSP_STATS_MAX_SLOTS];
+} dsp_stats_shm_t;
+
+typedef struct {
+    dsp_stats_counters_t counters;
+    dsp_stats_slot_t *slot;
+    uint32_t period;
+    uint32_t countdown;
+} dsp_stats_t;
+
+#ifdef DSP_STATS
+
+/// <summary>This method called from instantiate to claim a slot in the stats table of this process</summary>
+/// <returns>The private counter block, or NULL if there is no free slot or no shared memory</returns>
+dsp_stats_t *dsp_stats_open(const char *uri, const uint32_t sampleRate);
+
+/// <summary>This method called from cleanup to release the slot</summary>
+void dsp_stats_close(dsp_stats_t *stats);
+
+/// <summary>This method called at the start of run()</summary>
+/// <returns>The tick count to pass to dsp_stats_run_end</returns>
+uint64_t dsp_stats_ticks(void);
+
+/// <summary>This method called at the end of run() to time it and publish the counters when due</summary>
+void dsp_stats_run_end(dsp_stats_t *stats, const uint64_t start, const uint32_t n_samples);
+
+#define DSP_STATS_COUNT(stats, field) do { if (stats) (stats)->counters.field++; } while (0)
+#define DSP_STATS_RUN_BEGIN(start) const uint64_t start = dsp_stats_ticks()
+#define DSP_STATS_RUN_END(stats, start, n) do { if (stats) dsp_stats_run_end(stats, start, n); } while (0)
+
+#else
+
+#define DSP_STATS_COUNT(stats, field) do {} while (0)
+#define DSP_STATS_RUN_BEGIN(start) do {} while (0)
+#define DSP_STATS_RUN_END(stats, start, n) do {} while (0)
+
+#endif
+
+#endif //DSP_STATS_H_INCLUDED
@@ -0,0 +1,103 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_TABLES_H_INCLUDED
+#define DSP_TABLES_H_INCLUDED
+
+#include <stdint.h>
+
+// Lookup tables for the per sample math of the compressor. dsp_tables.c is written at build time
+// by gen-tables.c, the arrays are const so they live in .rodata, shared by every instance and every
+// process that loads a plugin, with nothing to compute at instantiate.
+// Each table has DSP_TABLE_SIZE segments plus the closing point, lookups interpolate linearly.
+
+#define DSP_TABLE_BITS 10
+#define DSP_TABLE_SIZE (1 << DSP_TABLE_BITS)
+
+// gen-tables fails the build if the interpolation error of a table is larger
+#define DSP_TABLE_MAX_ERROR 1e-6
+
+extern const float dsp_table_sine[DSP_TABLE_SIZE + 1]; // sin(pi/2 x) for x in [0, 1]
+extern const float dsp_table_exp2[DSP_TABLE_SIZE + 1]; // 2^x for x in [0, 1]
+extern const float dsp_table_log2[DSP_TABLE_SIZE + 1]; // log2(x) for x in [1, 2]
+
+// worst error of each table measured by gen-tables, as a linear gain error (absolute for the sine,
+// relative for the dB conversions), render-check -e checks the lookups below against it
+extern const double dsp_table_sine_error;
+extern const double dsp_table_exp2_error;
+extern const double dsp_table_log2_error;
+
+typedef union {
+    float f;
+    uint32_t i;
+} dsp_float_bits_t;
+
+static inline float dsp_table_lerp(const float *table, const uint32_t index, const float frac)
+{
+    return table[index] + (table[index + 1] - table[index]) * frac;
+}
+
+/// <summary>This method called to get sinf(pi/2 * x), the compressor gain curve</summary>
+/// <param name="x">Holds the gain, clamped to [0, 1]</param>
+static inline float dsp_sine_gain(float x)
+{
+    x = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+
+    const float pos = x * DSP_TABLE_SIZE;
+    uint32_t index = (uint32_t)pos;
+    if (index > DSP_TABLE_SIZE - 1)
+        index = DSP_TABLE_SIZE - 1;
+
+    return dsp_table_lerp(dsp_table_sine, index, pos - (float)index);
+}
+
+/// <summary>This method called to convert dB to linear, 10^(db/20)</summary>
+/// <param name="db">Holds the level in dB, anything below -758 dB returns the smallest normal float</param>
+static inline float dsp_db2lin(const float db)
+{
+    float x = db * 0.166096404744368f; // log2(10) / 20
+    x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+
+    int e = (int)x;
+    e -= (float)e > x; // floor, (int) truncates towards zero
+
+    const float pos = (x - (float)e) * DSP_TABLE_SIZE;
+    uint32_t index = (uint32_t)pos;
+    if (index > DSP_TABLE_SIZE - 1)
+        index = DSP_TABLE_SIZE - 1;
+
+    dsp_float_bits_t scale;
+    scale.i = (uint32_t)(e + 127) << 23;
+
+    return dsp_table_lerp(dsp_table_exp2, index, pos - (float)index) * scale.f;
+}
+
+/// <summary>This method called to convert linear to dB, 20 log10(lin)</summary>
+/// <param name="lin">Holds a positive normal float, the sign is ignored and zero is not handled</param>
+static inline float dsp_lin2db(const float lin)
+{
+    dsp_float_bits_t bits;
+    bits.f = lin;
+
+    const int e = (int)((bits.i >> 23) & 0xff) - 127;
+    const uint32_t mantissa = bits.i & 0x7fffff;
+    const uint32_t index = mantissa >> (23 - DSP_TABLE_BITS);
+    const float frac = (float)(mantissa & ((1 << (23 - DSP_TABLE_BITS)) - 1)) * (1.0f / (1 << (23 - DSP_TABLE_BITS)));
+
+    return ((float)e + dsp_table_lerp(dsp_table_log2, index, frac)) * 6.02059991327962f; // 20 log10(2)
+}
+
+#endif //DSP_TABLES_H_INCLUDED
@@ -0,0 +1,120 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DSP_TELEMETRY_H_INCLUDED
+#define DSP_TELEMETRY_H_INCLUDED
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp_arena.h"
+
+// Dynamics telemetry, always compiled in. The cores add to the current values while they
+// process, the plugin publishes them once per run() under a sequence lock, and any other thread
+// copies the published values through dsp_telemetry_read. The audio thread never waits on the
+// reader: a read that overlaps a publish is simply retried.
+// Plugins hand the reader to the host and UIs through the extension data DSP_TELEMETRY__interface.
+
+#define DSP_TELEMETRY__interface "http://moddevices.com/ns/mod-system-plugins#telemetry"
+
+// a reader gives up after this many publishes got in the way
+#define DSP_TELEMETRY_READ_RETRIES 16
+
+typedef struct {
+    uint64_t samples;
+    // compressor, the gain reduction is linear, 1.0 when the compressor does nothing
+    uint64_t gain_chunks;           // compressor chunks (SF_COMPRESSOR_SPU samples) in gain_sum
+    double gain_sum;                // gain reduction at the end of every chunk, summed
+    float gain_min;                 // deepest gain reduction since the last restart
+    float gain_last;
+    // gate
+    uint64_t gate_samples[3];       // samples spent in IDLE, HOLD and DECAY
+    uint64_t gate_opens;            // IDLE left
+    uint64_t gate_closes;           // IDLE entered again
+} dsp_telemetry_values_t;
+
+typedef struct {
+    dsp_telemetry_values_t current; // only touched by the audio thread
+    uint32_t restarted;
+    // what the readers touch starts on its own cache line, away from the per chunk updates of current
+    uint32_t restart DSP_CACHE_ALIGNED; // bumped by a reader to restart gain_min
+    uint32_t sequence;              // odd while the audio thread is publishing
+    dsp_telemetry_values_t published;
+} dsp_telemetry_t;
+
+typedef struct {
+    /// <summary>This method called from any thread but the audio one to copy the latest published values</summary>
+    /// <param name="restart">Holds 1 to start a new gain_min after this read</param>
+    /// <returns>0 if no consistent copy could be made, e.g. while the plugin is being run at a very small block size</returns>
+    int (*read)(void *instance, dsp_telemetry_values_t *values, int restart);
+} dsp_telemetry_interface_t;
+
+/// <summary>This method called from instantiate, before the telemetry is published or read</summary>
+static inline void dsp_telemetry_init(dsp_telemetry_t *telemetry)
+{
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->current.gain_min = 1.0f;
+    telemetry->current.gain_last = 1.0f;
+    telemetry->published = telemetry->current;
+}
+
+/// <summary>This method called at the end of run() to publish the values accumulated so far</summary>
+static inline void dsp_telemetry_publish(dsp_telemetry_t *telemetry, const uint32_t n_samples)
+{
+    const uint32_t sequence = telemetry->sequence;
+
+    telemetry->current.samples += n_samples;
+
+    __atomic_store_n(&telemetry->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&telemetry->published, &telemetry->current, sizeof(telemetry->current));
+    __atomic_store_n(&telemetry->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    //the published minimum still covers the blocks before the restart request
+    const uint32_t restart = __atomic_load_n(&telemetry->restart, __ATOMIC_RELAXED);
+    if (restart != telemetry->restarted)
+    {
+        telemetry->restarted = restart;
+        telemetry->current.gain_min = telemetry->current.gain_last;
+    }
+}
+
+/// <summary>This method called off the audio thread to copy the published values</summary>
+/// <param name="restart">Holds 1 to start a new gain_min after this read</param>
+/// <returns>0 if every attempt overlapped a publish</returns>
+static inline int dsp_telemetry_read(dsp_telemetry_t *telemetry, dsp_telemetry_values_t *values, const int restart)
+{
+    for (uint32_t i = 0; i < DSP_TELEMETRY_READ_RETRIES; i++)
+    {
+        const uint32_t before = __atomic_load_n(&telemetry->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1)
+            continue;
+
+        memcpy(values, &telemetry->published, sizeof(*values));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&telemetry->sequence, __ATOMIC_RELAXED) == before)
+        {
+            if (restart)
+                __atomic_add_fetch(&telemetry->restart, 1, __ATOMIC_RELAXED);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#endif //DSP_TELEMETRY_H_INCLUDED
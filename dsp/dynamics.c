@@ -0,0 +1,262 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "dynamics.h"
+
+#define DEZIPPER_CONSTANT  0.1
+
+/*******************************************************************************
+								system compressor
+*******************************************************************************/
+
+size_t dynamics_compressor_memory_size(const uint32_t maxBlock)
+{
+    return 2 * DSP_ARENA_SIZE(((maxBlock < 1) ? DYNAMICS_COMP_BLOCK : maxBlock) * sizeof(float));
+}
+
+int dynamics_compressor_init(dynamics_compressor_t *comp, const uint32_t sampleRate, const uint32_t maxBlock,
+                             dsp_arena_t *arena)
+{
+    comp->bfr_size = (maxBlock < 1) ? DYNAMICS_COMP_BLOCK : maxBlock;
+    comp->external = arena != NULL;
+    comp->bfr_l = (float*)dsp_arena_calloc(arena, comp->bfr_size, sizeof(float));
+    comp->bfr_r = (float*)dsp_arena_calloc(arena, comp->bfr_size, sizeof(float));
+
+    if (!comp->bfr_l || !comp->bfr_r)
+    {
+        dynamics_compressor_cleanup(comp);
+        return 0;
+    }
+
+    compressor_init(&comp->state, sampleRate);
+
+    // invalid initial values
+    comp->prev_release = comp->prev_mode = -9999;
+    comp->prev_volume = 1.f;
+
+    return 1;
+}
+
+void dynamics_compressor_cleanup(dynamics_compressor_t *comp)
+{
+    dsp_arena_release(comp->bfr_l, comp->external);
+    dsp_arena_release(comp->bfr_r, comp->external);
+    comp->bfr_l = comp->bfr_r = NULL;
+}
+
+static void dynamics_compressor_set_mode(dynamics_compressor_t *comp, const float mode, const float release)
+{
+    switch((int)mode)
+    {
+        //light compression
+        case DYNAMICS_COMP_LIGHT:
+            compressor_set_params(&comp->state, -12.f,
+                                    12.f, 2.f, 0.0001f, (release/1000), -3.f);
+        break;
+
+        //medium compression
+        case DYNAMICS_COMP_MEDIUM:
+            compressor_set_params(&comp->state, -12.f,
+                                    12.f, 3.f, 0.0001f, (release/1000), -3.f);
+        break;
+
+        //heavy compression
+        case DYNAMICS_COMP_HEAVY:
+            compressor_set_params(&comp->state, -15.f,
+                                    15.f, 4.f, 0.0001f, (release/1000), -3.f);
+        break;
+
+        //extreme compression
+        case DYNAMICS_COMP_EXTREME:
+        default:
+            compressor_set_params(&comp->state, -25.f,
+                                    15.f, 10.f, 0.0001f, (release/1000), -6.f);
+        break;
+    }
+}
+
+void dynamics_compressor_run(dynamics_compressor_t *comp, const float *input_l, const float *input_r,
+                             float *output_l, float *output_r, const uint32_t n_samples,
+                             const float mode, const float release, const float volume)
+{
+    if ((comp->prev_release != release) || (comp->prev_mode != mode)) {
+        dynamics_compressor_set_mode(comp, mode, release);
+
+        comp->prev_release = release;
+        comp->prev_mode = mode;
+    }
+
+    float linear_volume = cmop_db2lin(volume);
+
+    if ((int)mode != DYNAMICS_COMP_BYPASS)
+    {
+        //the buffers hold maxBlock samples, slices only happen for hosts running larger blocks
+        for (uint32_t offset = 0; offset < n_samples; offset += comp->bfr_size) {
+            const uint32_t n = (n_samples - offset < comp->bfr_size) ? n_samples - offset : comp->bfr_size;
+
+            compressor_process(&comp->state, n, input_l + offset, input_r + offset, comp->bfr_l, comp->bfr_r);
+
+            for (uint32_t i = 0; i < n; i++) {
+                //moving average over volume, reduces zipper noise
+                if (comp->prev_volume != linear_volume)
+                    comp->prev_volume = DEZIPPER_CONSTANT * linear_volume + (1.0 - DEZIPPER_CONSTANT) * comp->prev_volume;
+
+                output_l[offset + i] = comp->bfr_l[i] * comp->prev_volume;
+                output_r[offset + i] = comp->bfr_r[i] * comp->prev_volume;
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < n_samples; i++) {
+            //moving average over volume, reduces zipper noise
+            if (comp->prev_volume != linear_volume)
+                comp->prev_volume = DEZIPPER_CONSTANT * linear_volume + (1.0 - DEZIPPER_CONSTANT) * comp->prev_volume;
+
+            output_l[i] = input_l[i] * comp->prev_volume;
+            output_r[i] = input_r[i] * comp->prev_volume;
+        }
+    }
+}
+
+/*******************************************************************************
+								system noisegate
+*******************************************************************************/
+
+size_t dynamics_gate_memory_size(const uint32_t sampleRate)
+{
+    return Gate_MemorySize(sampleRate, GATE_DEFAULT_WINDOW_MS, 2, Gate_KeyDecimation(sampleRate), DYNAMICS_GATE_ATTACK);
+}
+
+int dynamics_gate_init(dynamics_gate_t *gate, const uint32_t sampleRate, dsp_arena_t *arena)
+{
+    gate->sampleRate = sampleRate;
+    gate->prevMode = -1;
+
+    if (!Gate_Init(&gate->gate, sampleRate, GATE_DEFAULT_WINDOW_MS, 2, Gate_KeyDecimation(sampleRate), arena))
+        return 0;
+
+    if (!Gate_InitLookahead(&gate->gate, sampleRate, DYNAMICS_GATE_ATTACK, arena))
+    {
+        Gate_Cleanup(&gate->gate);
+        return 0;
+    }
+
+    return 1;
+}
+
+void dynamics_gate_cleanup(dynamics_gate_t *gate)
+{
+    Gate_Cleanup(&gate->gate);
+}
+
+uint32_t dynamics_gate_run(dynamics_gate_t *gate, const float *input_1, const float *input_2,
+                           float *output_1, float *output_2, const uint32_t n_samples,
+                           const float mode_value, const float threshold, const float decay, const float lookahead)
+{
+    //update parameters
+    //lower threshold is 20dB lower
+    Gate_UpdateParameters(&gate->gate, gate->sampleRate, DYNAMICS_GATE_ATTACK, 1,
+                         (uint32_t)decay, 1, threshold, threshold - 20.0f);
+
+    Gate_SetLookahead(&gate->gate, lookahead > 0.5f);
+
+    const uint32_t latency = Gate_GetLatency(&gate->gate);
+    const int mode = (int)mode_value;
+
+    //the windows hold the key of the previous channel selection
+    if (mode != gate->prevMode)
+    {
+        Gate_ResetKey(&gate->gate);
+        gate->prevMode = mode;
+    }
+
+    float gain[GATE_BLOCK_SIZE];
+    float delayed_1[GATE_BLOCK_SIZE];
+    float delayed_2[GATE_BLOCK_SIZE];
+
+    for (uint32_t pos = 0; pos < n_samples; pos += GATE_BLOCK_SIZE)
+    {
+        const uint32_t len = (n_samples - pos < GATE_BLOCK_SIZE) ? n_samples - pos : GATE_BLOCK_SIZE;
+
+        const float* in_1 = input_1 + pos;
+        const float* in_2 = input_2 + pos;
+        float* out_1 = output_1 + pos;
+        float* out_2 = output_2 + pos;
+
+        //run the detector on the undelayed input first, the outputs may share the input buffers
+        switch(mode)
+        {
+            case DYNAMICS_GATE_IN1:
+                Gate_ComputeGain(&gate->gate, in_1, NULL, gain, len);
+            break;
+
+            case DYNAMICS_GATE_IN2:
+                Gate_ComputeGain(&gate->gate, in_2, NULL, gain, len);
+            break;
+
+            //stereo is handled when computing the key to get the highest one
+            case DYNAMICS_GATE_STEREO:
+                Gate_ComputeGain(&gate->gate, in_1, in_2, gain, len);
+            break;
+        }
+
+        //both channels are delayed in every mode, so the reported latency does not depend on it
+        in_1 = Gate_DelayBlock(&gate->gate, 0, in_1, delayed_1, len);
+        in_2 = Gate_DelayBlock(&gate->gate, 1, in_2, delayed_2, len);
+
+        switch(mode)
+        {
+            //off, copy 1 & 2
+            case DYNAMICS_GATE_OFF:
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    out_1[i] = in_1[i];
+                    out_2[i] = in_2[i];
+                }
+            break;
+
+            //inp 1 only, copy 2
+            case DYNAMICS_GATE_IN1:
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    out_1[i] = in_1[i] * gain[i];
+                    out_2[i] = in_2[i];
+                }
+            break;
+
+            //inp 2 only, copy 1
+            case DYNAMICS_GATE_IN2:
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    out_1[i] = in_1[i];
+                    out_2[i] = in_2[i] * gain[i];
+                }
+            break;
+
+            //the gate is computed once, apply it to both
+            case DYNAMICS_GATE_STEREO:
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    out_1[i] = in_1[i] * gain[i];
+                    out_2[i] = in_2[i] * gain[i];
+                }
+            break;
+        }
+    }
+
+    return latency;
+}
@@ -0,0 +1,112 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef DYNAMICS_H_INCLUDED
+#define DYNAMICS_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "compressor_core.h"
+#include "gate_core.h"
+#include "dsp_arena.h"
+
+// The system compressor and system noisegate as the plugins run them: the compressor mode presets,
+// the master volume dezipper, the gate channel modes and the lookahead. The plugins are thin LV2
+// wrappers around these, so anything else built on them sounds exactly like the plugins.
+
+// compressor modes, as in system-compressor.ttl
+#define DYNAMICS_COMP_BYPASS  0
+#define DYNAMICS_COMP_LIGHT   1
+#define DYNAMICS_COMP_MEDIUM  2
+#define DYNAMICS_COMP_HEAVY   3
+#define DYNAMICS_COMP_EXTREME 4
+
+// gate modes, as in system-noisegate.ttl
+#define DYNAMICS_GATE_OFF    0
+#define DYNAMICS_GATE_IN1    1
+#define DYNAMICS_GATE_IN2    2
+#define DYNAMICS_GATE_STEREO 3
+
+// the system noisegate attack is fixed, so is its longest lookahead
+#define DYNAMICS_GATE_ATTACK 10
+
+// scratch length of the compressor when the host does not give a block length
+#define DYNAMICS_COMP_BLOCK 256
+
+typedef struct {
+    sf_compressor_state_st state DSP_CACHE_ALIGNED;
+
+    float *bfr_l;
+    float *bfr_r;
+    uint32_t bfr_size;
+    int external;
+
+    float prev_release;
+    float prev_mode;
+    float prev_volume;
+} dynamics_compressor_t;
+
+typedef struct {
+    gate_t gate DSP_CACHE_ALIGNED;
+
+    uint32_t sampleRate;
+    int prevMode;
+} dynamics_gate_t;
+
+/// <summary>This method called to get the arena space dynamics_compressor_init takes</summary>
+size_t dynamics_compressor_memory_size(const uint32_t maxBlock);
+
+/// <summary>This method called to initialize the system compressor</summary>
+/// <param name="maxBlock">Holds the longest block dynamics_compressor_run gets without slicing it</param>
+/// <param name="arena">Holds the arena the scratch buffers are taken from, NULL allocates them from the heap</param>
+/// <returns>0 if the buffers could not be allocated</returns>
+int dynamics_compressor_init(dynamics_compressor_t *comp, const uint32_t sampleRate, const uint32_t maxBlock,
+                             dsp_arena_t *arena);
+
+/// <summary>This method called to free the buffers of dynamics_compressor_init</summary>
+void dynamics_compressor_cleanup(dynamics_compressor_t *comp);
+
+/// <summary>This method called to run the system compressor on a stereo block, the outputs may be the inputs</summary>
+/// <param name="mode">Holds the COMP_MODE control, one of DYNAMICS_COMP_*</param>
+/// <param name="release">Holds the RELEASE control in ms</param>
+/// <param name="volume">Holds the MASTER_VOL control in dB, dezippered</param>
+void dynamics_compressor_run(dynamics_compressor_t *comp, const float *input_l, const float *input_r,
+                             float *output_l, float *output_r, const uint32_t n_samples,
+                             const float mode, const float release, const float volume);
+
+/// <summary>This method called to get the arena space dynamics_gate_init takes</summary>
+size_t dynamics_gate_memory_size(const uint32_t sampleRate);
+
+/// <summary>This method called to initialize the system noisegate, with its stereo detector and lookahead</summary>
+/// <param name="arena">Holds the arena the windows and delay lines are taken from, NULL allocates them from the heap</param>
+/// <returns>0 if the buffers could not be allocated</returns>
+int dynamics_gate_init(dynamics_gate_t *gate, const uint32_t sampleRate, dsp_arena_t *arena);
+
+/// <summary>This method called to free the buffers of dynamics_gate_init</summary>
+void dynamics_gate_cleanup(dynamics_gate_t *gate);
+
+/// <summary>This method called to run the system noisegate on a stereo block, the outputs may be the inputs</summary>
+/// <param name="mode">Holds the Gate_Mode control, one of DYNAMICS_GATE_*</param>
+/// <param name="threshold">Holds the Threshold control in dB, the gate closes 20dB below it</param>
+/// <param name="decay">Holds the Decay control in ms</param>
+/// <param name="lookahead">Holds the Lookahead control, on above 0.5</param>
+/// <returns>The latency in samples, see Gate_GetLatency</returns>
+uint32_t dynamics_gate_run(dynamics_gate_t *gate, const float *input_1, const float *input_2,
+                           float *output_1, float *output_2, const uint32_t n_samples,
+                           const float mode, const float threshold, const float decay, const float lookahead);
+
+#endif //DYNAMICS_H_INCLUDED
@@ -0,0 +1,639 @@
+/*
+  ==============================================================================
+
+ * VeJa NoiseGate
+ * Copyright (C) 2022 Jan Janssen <veja.plugins@gmail.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#include "gate_core.h"
+#include "circular_buffer.h"
+#include "dsp_dispatch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*******************************************************************************
+								global functions
+*******************************************************************************/
+
+static inline uint32_t gate_clamp_decimation(const uint32_t decimation)
+{
+    return (decimation < 1) ? 1 : (decimation > GATE_MAX_DECIMATION) ? GATE_MAX_DECIMATION : decimation;
+}
+
+//the window covers the same time at the decimated rate
+static inline uint32_t gate_window_size(const uint32_t sampleRate, const float windowLength, const uint32_t decimation)
+{
+    return (uint32_t)(windowLength * sampleRate * 0.001f * (1.0f / decimation) + 0.5f);
+}
+
+static inline uint32_t gate_lookahead_size(const uint32_t sampleRate, const uint32_t maxAttack, const uint32_t windowSize,
+                                           const uint32_t decimation)
+{
+    const uint32_t tau = sampleRate * 0.001f;
+    return maxAttack * tau + windowSize * decimation + 1;
+}
+
+size_t Gate_MemorySize(const uint32_t sampleRate, const float windowLength, const uint32_t channels,
+                       const uint32_t decimation, const uint32_t maxAttack)
+{
+    const uint32_t windows = (channels > 1) ? 2 : 1;
+    const uint32_t decim = gate_clamp_decimation(decimation);
+    const uint32_t windowSize = gate_window_size(sampleRate, windowLength, decim);
+    size_t size = windows * ringbuffer_memory_size(windowSize);
+
+    if (maxAttack > 0)
+        size += windows * delayline_memory_size(gate_lookahead_size(sampleRate, maxAttack, windowSize, decim));
+
+    return size;
+}
+
+int Gate_Init(gate_t *gate, const uint32_t sampleRate, const float windowLength, const uint32_t channels,
+              const uint32_t decimation, dsp_arena_t *arena)
+{
+    gate->_alpha = 1.0f;
+    gate->_rmsValue = 0.0f;
+    gate->_keyValue = 0.0f;
+    gate->_upperThreshold = 0.0f;
+    gate->_lowerThreshold = 0.0f;
+    gate->_attackTime = 0;
+    gate->_decayTime = 0;
+    gate->_holdTime = 0;
+    gate->_attackCounter = 0;
+    gate->_decayCounter = 0;
+    gate->_holdCounter = 0;
+    gate->_currentState = IDLE;
+    gate->_tau = 0;
+    gate->_keyMode = GATE_KEY_AVERAGE;
+    gate->_channels = (channels > 1) ? 2 : 1;
+
+    gate->_gainFactor = 0.0f;
+    gate->_gain = 0.0f;
+    gate->_gainTarget = 0.0f;
+    gate->_gainDelta = 0.0f;
+
+    gate->_decimation = gate_clamp_decimation(decimation);
+    gate->_decimationInv = 1.0f / gate->_decimation;
+    gate->_decimCount = 0;
+    gate->_decimAcc1 = 0.0f;
+    gate->_decimAcc2 = 0.0f;
+    gate->_keyReady = 0;
+
+    const uint32_t windowSize = gate_window_size(sampleRate, windowLength, gate->_decimation);
+
+    gate->window2.m_buffer = NULL;
+    gate->window2.m_peak = NULL;
+    gate->delay1.m_buffer = NULL;
+    gate->delay2.m_buffer = NULL;
+    gate->window2.m_external = 0;
+    gate->delay1.m_external = 0;
+    gate->delay2.m_external = 0;
+    gate->_lookahead = 0;
+    gate->_lookaheadMax = 0;
+    gate->_lookaheadEnabled = 0;
+
+    dsp_telemetry_init(&gate->telemetry);
+
+#ifdef DSP_STATS
+    gate->stats = NULL;
+#endif
+
+    if (!ringbuffer_init(&gate->window1, windowSize, arena))
+        return 0;
+
+    if (gate->_channels == 2 && !ringbuffer_init(&gate->window2, windowSize, arena))
+    {
+        ringbuffer_free(&gate->window1);
+        return 0;
+    }
+
+    return 1;
+}
+
+uint32_t Gate_WindowSize(const uint32_t sampleRate, const float windowLength, const uint32_t decimation)
+{
+    return gate_window_size(sampleRate, windowLength, gate_clamp_decimation(decimation));
+}
+
+uint32_t Gate_KeyDecimation(const uint32_t sampleRate)
+{
+#ifndef DSP_GATE_KEY_DECIMATION
+    //the decimated key ramps the gain between its steps, which changes the sound, so it is opt-in
+    (void)sampleRate;
+    return 1;
+#else
+    if (sampleRate >= 192000)
+        return 8;
+    if (sampleRate >= 96000)
+        return 4;
+
+    return 1;
+#endif
+}
+
+int Gate_InitLookahead(gate_t *gate, const uint32_t sampleRate, const uint32_t maxAttack, dsp_arena_t *arena)
+{
+    const uint32_t size = gate_lookahead_size(sampleRate, maxAttack, gate->window1.S, gate->_decimation);
+
+    if (!delayline_init(&gate->delay1, size, arena))
+        return 0;
+
+    if (gate->_channels == 2 && !delayline_init(&gate->delay2, size, arena))
+    {
+        delayline_free(&gate->delay1);
+        return 0;
+    }
+
+    delayline_set_fade(&gate->delay1, sampleRate * GATE_LOOKAHEAD_FADE_MS / 1000);
+    if (gate->_channels == 2)
+        delayline_set_fade(&gate->delay2, sampleRate * GATE_LOOKAHEAD_FADE_MS / 1000);
+
+    gate->_lookaheadMax = size - 1;
+    return 1;
+}
+
+void Gate_Cleanup(gate_t *gate)
+{
+    ringbuffer_free(&gate->window1);
+    ringbuffer_free(&gate->window2);
+    delayline_free(&gate->delay1);
+    delayline_free(&gate->delay2);
+}
+
+static inline void gate_update_lookahead(gate_t *gate)
+{
+    if (!gate->_lookaheadEnabled)
+    {
+        gate->_lookahead = 0;
+        return;
+    }
+
+    //the window mean lags the input, so the detector needs the full window ahead as well
+    const uint32_t lookahead = (gate->_attackTime + gate->window1.S) * gate->_decimation;
+    gate->_lookahead = (lookahead < gate->_lookaheadMax) ? lookahead : gate->_lookaheadMax;
+}
+
+void Gate_UpdateParameters(gate_t *gate, const uint32_t sampleRate, const uint32_t attack, const uint32_t hold,
+                            const uint32_t decay, const uint32_t alpha, const float upperThreshold,
+                            const float lowerThreshold)
+{
+    gate->_tau = sampleRate * 0.001f * gate->_decimationInv; //sample time in ms, at the key rate
+    
+    gate->_upperThreshold = powf(10.0f, (upperThreshold / 20.0f)); // dB to level
+    gate->_lowerThreshold = powf(10.0f, (lowerThreshold / 20.0f));
+    gate->_attackTime = attack * gate->_tau;
+    gate->_decayTime = decay * gate->_tau;
+    gate->_holdTime = hold * gate->_tau;
+    gate->_alpha = alpha;
+
+    gate_update_lookahead(gate);
+}
+
+static inline void gate_update_state(gate_t *gate)
+{
+    const uint32_t previousState = gate->_currentState;
+    dsp_telemetry_values_t *telemetry = &gate->telemetry.current;
+
+    //one step covers _decimation samples
+    switch (gate->_currentState)
+    {
+        case IDLE:
+            telemetry->gate_samples[IDLE] += gate->_decimation;
+            gate->_rmsValue = fabsf(gate->_keyValue) * 0.707106781187f;
+
+            // add a bit of hysterisis in case the gate is in atack state and the RMS is close to the threshold, avoid rapid open/close states
+            if ((gate->_rmsValue < gate->_upperThreshold) && (gate->_attackCounter != 0))
+            {
+                gate->_rmsValue += 0.1f;
+            }
+
+            if (gate->_rmsValue > gate->_upperThreshold)
+            {
+                if (gate->_attackCounter > gate->_attackTime)
+                {
+                    gate->_currentState = HOLD;
+                    gate->_holdCounter = 0;
+                    gate->_attackCounter = 0;
+                    gate->_gainFactor = 1.0f;
+                }
+                else
+                {
+                    gate->_attackCounter++;
+                    if (gate->_attackCounter != 0) 
+                        gate->_gainFactor = (powf((float)gate->_attackCounter, 2.0f) / powf((float)gate->_attackTime, 2.0f));
+                    else 
+                        gate->_gainFactor = 0.0f;
+                }
+            }
+            else
+            {
+                if (gate->_attackCounter != 0)
+                {
+                    if (gate->_attackCounter > gate->_holdTime)
+                    {
+                        gate->_currentState = HOLD;
+                        gate->_holdCounter = 0;
+                        gate->_attackCounter = 0;
+                        gate->_gainFactor = 1.0f;
+                    }
+                    else
+                    {
+                        gate->_currentState = DECAY;
+                        gate->_decayCounter = gate->_attackCounter;
+                        gate->_holdCounter = 0;
+                        gate->_attackCounter = 0;
+                        gate->_gainFactor = powf((float)gate->_decayCounter, 2.0f) / powf((float)gate->_attackTime, 2.0f);
+                    }
+                }
+                else
+                    gate->_gainFactor = 0.0f;
+            }
+        break;
+
+        case HOLD:
+            telemetry->gate_samples[HOLD] += gate->_decimation;
+            gate->_rmsValue = fabsf(gate->_keyValue) * 0.707106781187f;
+            if (gate->_rmsValue > gate->_lowerThreshold)
+                gate->_holdCounter = 0;
+            else if (gate->_holdCounter < gate->_holdTime)
+                gate->_holdCounter++;
+            else if (gate->_holdCounter >= gate->_holdTime)
+            {
+                gate->_currentState = DECAY;
+                gate->_decayCounter = 0;
+            }
+
+            gate->_gainFactor = 1.0f;
+        break;
+
+        case DECAY:
+            telemetry->gate_samples[DECAY] += gate->_decimation;
+            gate->_rmsValue = fabsf(gate->_keyValue) * 0.707106781187f;
+            if (gate->_rmsValue > gate->_upperThreshold)
+            {
+                if (gate->_attackCounter > gate->_attackTime)
+                {
+                    gate->_currentState = HOLD;
+                    gate->_holdCounter = 0;
+                    gate->_attackCounter = 0;
+                    gate->_gainFactor = 1.0f;
+                }
+                else
+                {
+                    gate->_attackCounter++;
+                    gate->_decayCounter++;
+                    gate->_gainFactor = powf((float)gate->_decayCounter - (float)gate->_decayTime, 2.0f) / powf((float)gate->_decayTime, 2.0f);
+                }
+            }
+            else if (gate->_decayCounter > gate->_decayTime)
+            {
+                gate->_currentState = IDLE;
+                gate->_gainFactor = 0.0f;
+            }
+            else
+            {
+                float dif = (float)gate->_decayCounter - (float)gate->_decayTime;
+                if (gate->_decayCounter != 0) 
+                {
+                    gate->_decayCounter++;
+                    gate->_gainFactor = powf(dif, 2.0f) / powf((float)gate->_decayTime, 2.0f);
+                }
+                else
+                {
+                    gate->_decayCounter++;
+                    gate->_gainFactor = 1.0f;
+                }
+            }
+        break;
+    }  
+
+    if (gate->_currentState != previousState)
+    {
+        if (previousState == IDLE)
+            telemetry->gate_opens++;
+        else if (gate->_currentState == IDLE)
+            telemetry->gate_closes++;
+    }
+
+#ifdef DSP_STATS
+    if (gate->stats)
+    {
+        gate->stats->counters.gate_steps[previousState]++;
+        if (gate->_currentState != previousState)
+            gate->stats->counters.gate_transitions++;
+    }
+#endif
+}
+
+static inline float gate_next_gain(gate_t *gate)
+{
+    if (gate->_decimation == 1)
+    {
+        gate_update_state(gate);
+        gate->_gain = gate->_gainFactor;
+        return gate->_gain;
+    }
+
+    //the state machine advances once per decimated key sample, ramp the gain towards it in between
+    if (gate->_keyReady)
+    {
+        gate->_keyReady = 0;
+        gate->_gain = gate->_gainTarget;
+        gate_update_state(gate);
+        gate->_gainTarget = gate->_gainFactor;
+        gate->_gainDelta = (gate->_gainTarget - gate->_gain) * gate->_decimationInv;
+    }
+
+    gate->_gain += gate->_gainDelta;
+    return gate->_gain;
+}
+
+float Gate_RunGate(gate_t *gate, const float input)
+{
+    return input * gate_next_gain(gate);
+}
+
+void Gate_ComputeGain(gate_t *gate, const float *key1, const float *key2, float *gain, const uint32_t n_samples)
+{
+    float keys1[GATE_BLOCK_SIZE];
+    float keys2[GATE_BLOCK_SIZE];
+
+    if (gate->_decimation != 1 || gate->_keyMode != GATE_KEY_AVERAGE)
+    {
+        for (uint32_t i = 0; i < n_samples; i++)
+        {
+            if (key2)
+                Gate_PushSamples(gate, key1[i], key2[i]);
+            else
+                Gate_PushSample(gate, key1[i]);
+
+            gain[i] = gate_next_gain(gate);
+        }
+        return;
+    }
+
+    //full rate average key, computed for the whole chunk up front
+    ringbuffer_push_and_calculate_power_block(&gate->window1, key1, keys1, n_samples);
+
+    if (key2)
+    {
+        ringbuffer_push_and_calculate_power_block(&gate->window2, key2, keys2, n_samples);
+
+        for (uint32_t i = 0; i < n_samples; i++)
+            keys1[i] = (keys1[i] > keys2[i]) ? keys1[i] : keys2[i];
+    }
+
+    //the state machine is sequential, it reads the precomputed keys
+    for (uint32_t i = 0; i < n_samples; i++)
+    {
+        gate->_keyValue = keys1[i];
+        gain[i] = gate_next_gain(gate);
+    }
+}
+
+const float * Gate_DelayBlock(gate_t *gate, const uint32_t channel, const float *input, float *buffer,
+                              const uint32_t n_samples)
+{
+    if (gate->_lookahead == 0)
+        return input;
+
+    delayline_t *line = (channel == 0) ? &gate->delay1 : &gate->delay2;
+
+    for (uint32_t i = 0; i < n_samples; i++)
+        buffer[i] = delayline_process(line, input[i], gate->_lookahead);
+
+    return buffer;
+}
+
+DSP_KERNEL
+void Gate_RunBlock(gate_t *gate, const float *key, const float *input, float *output, float *cv,
+                   const uint32_t n_samples, const gate_cv_mode_t cvMode)
+{
+    float gain[GATE_BLOCK_SIZE];
+    float delayed[GATE_BLOCK_SIZE];
+
+    for (uint32_t pos = 0; pos < n_samples; pos += GATE_BLOCK_SIZE)
+    {
+        const uint32_t len = (n_samples - pos < GATE_BLOCK_SIZE) ? n_samples - pos : GATE_BLOCK_SIZE;
+
+        //collect the gain curve for this chunk first
+        Gate_ComputeGain(gate, key + pos, NULL, gain, len);
+
+        //then apply the gain and write the CV in a single vectorizable pass
+        const float *in = Gate_DelayBlock(gate, 0, input + pos, delayed, len);
+        float *out = output + pos;
+        float *cvout = cv + pos;
+
+        if (cvMode == GATE_CV_GAIN)
+        {
+            for (uint32_t i = 0; i < len; i++)
+            {
+                out[i] = in[i] * gain[i];
+                cvout[i] = gain[i] * GATE_CV_MAX;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < len; i++)
+            {
+                out[i] = in[i] * gain[i];
+                cvout[i] = (gain[i] > 0.0f) ? GATE_CV_MAX : 0.0f;
+            }
+        }
+    }
+}
+
+DSP_KERNEL
+void Gate_RunBlockLinked(gate_t *gate, const float *const *input, float *const *output,
+                         const uint32_t channels, const uint32_t n_samples)
+{
+    float gain[GATE_BLOCK_SIZE];
+    float key[GATE_BLOCK_SIZE];
+
+    for (uint32_t pos = 0; pos < n_samples; pos += GATE_BLOCK_SIZE)
+    {
+        const uint32_t len = (n_samples - pos < GATE_BLOCK_SIZE) ? n_samples - pos : GATE_BLOCK_SIZE;
+
+        //linked key, the loudest channel of every sample feeds the one detector
+        for (uint32_t i = 0; i < len; i++)
+            key[i] = fabsf(input[0][pos + i]);
+
+        for (uint32_t c = 1; c < channels; c++)
+        {
+            const float *in = input[c] + pos;
+
+            for (uint32_t i = 0; i < len; i++)
+            {
+                const float x = fabsf(in[i]);
+                key[i] = (x > key[i]) ? x : key[i];
+            }
+        }
+
+        //one state machine pass for all channels
+        Gate_ComputeGain(gate, key, NULL, gain, len);
+
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            const float *in = input[c] + pos;
+            float *out = output[c] + pos;
+
+            for (uint32_t i = 0; i < len; i++)
+                out[i] = in[i] * gain[i];
+        }
+    }
+}
+
+float Gate_ApplyGate(gate_t *gate, const float input)
+{
+    return input * gate->_gain; 
+}
+
+void Gate_SetKeyMode(gate_t *gate, const gate_key_mode_t mode)
+{
+    if (gate->_keyMode == mode)
+        return;
+
+    //the windows only hold valid state for the detector that filled them
+    Gate_ResetKey(gate);
+
+    gate->_keyMode = mode;
+}
+
+void Gate_SetLookahead(gate_t *gate, const int enabled)
+{
+    if (gate->_lookaheadMax == 0 || gate->_lookaheadEnabled == enabled)
+        return;
+
+    //do not replay stale audio from when the lookahead was last enabled
+    if (enabled)
+    {
+        delayline_clear(&gate->delay1);
+
+        if (gate->_channels == 2)
+            delayline_clear(&gate->delay2);
+    }
+
+    gate->_lookaheadEnabled = enabled;
+    gate_update_lookahead(gate);
+}
+
+uint32_t Gate_GetLatency(gate_t *gate)
+{
+    return gate->_lookahead;
+}
+
+float Gate_Delay(gate_t *gate, const uint32_t channel, const float input)
+{
+    if (gate->_lookahead == 0)
+        return input;
+
+    return delayline_process((channel == 0) ? &gate->delay1 : &gate->delay2, input, gate->_lookahead);
+}
+
+void Gate_ResetKey(gate_t *gate)
+{
+    ringbuffer_clear(&gate->window1);
+
+    if (gate->_channels == 2)
+        ringbuffer_clear(&gate->window2);
+
+    gate->_keyValue = 0.0f;
+    gate->_decimCount = 0;
+    gate->_decimAcc1 = 0.0f;
+    gate->_decimAcc2 = 0.0f;
+}
+
+//boxcar pre-decimator, average of |x| for the average key and maximum for the peak key
+static inline void gate_accumulate(gate_t *gate, float *acc, const float input)
+{
+    const float x = fabsf(input);
+
+    if (gate->_keyMode == GATE_KEY_PEAK)
+        *acc = (x > *acc) ? x : *acc;
+    else
+        *acc += x;
+}
+
+static inline float gate_decimated(gate_t *gate, float *acc)
+{
+    const float x = (gate->_keyMode == GATE_KEY_PEAK) ? *acc : *acc * gate->_decimationInv;
+
+    *acc = 0.0f;
+    return x;
+}
+
+static inline int gate_decimation_step(gate_t *gate)
+{
+    if (++gate->_decimCount < gate->_decimation)
+        return 0;
+
+    gate->_decimCount = 0;
+    gate->_keyReady = 1;
+    return 1;
+}
+
+void Gate_PushSample(gate_t *gate, const float input)
+{
+    float x = input;
+
+    if (gate->_decimation != 1)
+    {
+        gate_accumulate(gate, &gate->_decimAcc1, input);
+
+        if (!gate_decimation_step(gate))
+            return;
+
+        x = gate_decimated(gate, &gate->_decimAcc1);
+    }
+
+    if (gate->_keyMode == GATE_KEY_PEAK)
+        gate->_keyValue = ringbuffer_push_and_calculate_peak(&gate->window1, x);
+    else
+        gate->_keyValue = ringbuffer_push_and_calculate_power(&gate->window1, x);
+}
+
+void Gate_PushSamples(gate_t *gate, float input1, float input2)
+{
+    float key1, key2;
+
+    if (gate->_decimation != 1)
+    {
+        gate_accumulate(gate, &gate->_decimAcc1, input1);
+        gate_accumulate(gate, &gate->_decimAcc2, input2);
+
+        if (!gate_decimation_step(gate))
+            return;
+
+        input1 = gate_decimated(gate, &gate->_decimAcc1);
+        input2 = gate_decimated(gate, &gate->_decimAcc2);
+    }
+
+    if (gate->_keyMode == GATE_KEY_PEAK)
+    {
+        key1 = ringbuffer_push_and_calculate_peak(&gate->window1, input1);
+        key2 = ringbuffer_push_and_calculate_peak(&gate->window2, input2);
+    }
+    else
+    {
+        key1 = ringbuffer_push_and_calculate_power(&gate->window1, input1);
+        key2 = ringbuffer_push_and_calculate_power(&gate->window2, input2);
+    }
+
+    //get new keyValue
+    gate->_keyValue = (key1>key2) ? key1 : key2;
+}
\ No newline at end of file
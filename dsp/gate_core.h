@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+ * VEJA NoiseGate
+ * Copyright (C) 2021 Jan Janssen <jan@moddevices.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#ifndef GATE_CORE_H_INCLUDED
+#define GATE_CORE_H_INCLUDED
+
+#include <stdint.h> 
+#include "circular_buffer.h"
+#include "dsp_stats.h"
+#include "dsp_telemetry.h"
+
+// detector window length, 128 samples at 48kHz
+#define GATE_DEFAULT_WINDOW_MS 2.667f
+
+typedef enum {
+    IDLE,
+    HOLD,
+    DECAY
+} gate_state_t;
+
+// crossfade of the lookahead delay when the attack time moves it
+#define GATE_LOOKAHEAD_FADE_MS 5
+
+// chunk length used by the block functions to batch the key and the gain curve
+#define GATE_BLOCK_SIZE 64
+
+// largest key decimation factor, see Gate_KeyDecimation
+#define GATE_MAX_DECIMATION 8
+
+// channel limit for the linked block API
+#define GATE_MAX_CHANNELS 8
+
+// CV output range is 0-10V
+#define GATE_CV_MAX 10.0f
+
+typedef enum {
+    GATE_CV_STATE,
+    GATE_CV_GAIN
+} gate_cv_mode_t;
+
+typedef enum {
+    GATE_KEY_AVERAGE,
+    GATE_KEY_PEAK
+} gate_key_mode_t;
+
+typedef struct GATE_T {
+    float _alpha;
+    float _rmsValue, _keyValue, _upperThreshold, _lowerThreshold, _gainFactor;
+    uint32_t _attackTime, _decayTime, _holdTime;
+    uint32_t _attackCounter, _decayCounter, _holdCounter;
+    uint32_t _currentState;
+    uint32_t _tau;
+    
+    gate_state_t state;
+    gate_key_mode_t _keyMode;
+    uint32_t _channels;
+
+    ringbuffer_t window1;
+    ringbuffer_t window2; // only allocated for stereo detection
+
+    // decimated key path, the windows and the state machine run at 1/_decimation rate
+    uint32_t _decimation, _decimCount;
+    float _decimationInv, _decimAcc1, _decimAcc2;
+    int _keyReady;
+
+    // gain applied to the audio, ramped between the decimated state machine steps
+    float _gain, _gainTarget, _gainDelta;
+
+    // lookahead, the audio is delayed by the attack time plus the detector window, a new attack time
+    // crossfades the delay lines to their new length
+    delayline_t delay1;
+    delayline_t delay2;
+    uint32_t _lookahead, _lookaheadMax;
+    int _lookaheadEnabled;
+
+    // state residency and open/close counts, published by the plugin
+    dsp_telemetry_t telemetry;
+
+#ifdef DSP_STATS
+    // hot path counters, NULL unless the plugin opened them
+    dsp_stats_t *stats;
+#endif
+} gate_t;
+
+/// <summary>This method called to initialize the Gate, allocates the detector windows</summary>
+/// <param name="sampleRate">Holds the sample rate the windows are sized for</param>
+/// <param name="windowLength">Holds the detector window length in ms</param>
+/// <param name="channels">Holds the number of detector windows, 1 for mono or 2 for stereo</param>
+/// <param name="decimation">Holds the key decimation factor, 1 runs the key at the full sample rate</param>
+/// <param name="arena">Holds the arena the windows are taken from, NULL allocates them from the heap</param>
+/// <returns>0 if the windows could not be allocated</returns>
+int Gate_Init(gate_t *gate, const uint32_t sampleRate, const float windowLength, const uint32_t channels,
+              const uint32_t decimation, dsp_arena_t *arena);
+
+/// <summary>This method called to get the arena space Gate_Init and Gate_InitLookahead take</summary>
+/// <param name="maxAttack">Holds the maxAttack passed to Gate_InitLookahead, 0 without lookahead</param>
+size_t Gate_MemorySize(const uint32_t sampleRate, const float windowLength, const uint32_t channels,
+                       const uint32_t decimation, const uint32_t maxAttack);
+
+/// <summary>This method called to get the detector window length in samples Gate_Init sizes the windows to</summary>
+uint32_t Gate_WindowSize(const uint32_t sampleRate, const float windowLength, const uint32_t decimation);
+
+/// <summary>This method called to get the key decimation the plugins use for a sample rate</summary>
+/// <returns>1, unless built with DSP_GATE_KEY_DECIMATION: then 1 up to 48kHz, 4 from 96kHz and 8 from 192kHz</returns>
+uint32_t Gate_KeyDecimation(const uint32_t sampleRate);
+
+/// <summary>This method called to allocate the lookahead delay lines, one per channel</summary>
+/// <param name="maxAttack">Holds the longest attack time in ms the lookahead has to cover</param>
+/// <returns>0 if the delay lines could not be allocated</returns>
+int Gate_InitLookahead(gate_t *gate, const uint32_t sampleRate, const uint32_t maxAttack, dsp_arena_t *arena);
+
+/// <summary>This method called to free the memory allocated in Gate_Init and Gate_InitLookahead</summary>
+void Gate_Cleanup(gate_t *gate);
+
+/// <summary>This method called to run the Gate and apply it to the input sample</summary>
+/// <param name="input">Holds input sample</param> 
+float Gate_RunGate(gate_t *gate, const float input);
+
+/// <summary>This method called to run the detector and the Gate over a chunk, without applying it</summary>
+/// <param name="key1">Holds the key samples</param>
+/// <param name="key2">Holds the second key for stereo detection, or NULL for mono</param>
+/// <param name="gain">Receives the gain curve</param>
+/// <param name="n_samples">Holds the chunk length, up to GATE_BLOCK_SIZE</param>
+void Gate_ComputeGain(gate_t *gate, const float *key1, const float *key2, float *gain, const uint32_t n_samples);
+
+/// <summary>This method called to delay a chunk by the lookahead</summary>
+/// <param name="buffer">Holds room for n_samples, up to GATE_BLOCK_SIZE</param>
+/// <returns>The delayed chunk, which is input itself if the lookahead is disabled</returns>
+const float * Gate_DelayBlock(gate_t *gate, const uint32_t channel, const float *input, float *buffer,
+                              const uint32_t n_samples);
+
+/// <summary>This method called to run the Gate over a block, keyed by a separate input</summary>
+/// <param name="key">Holds the key samples that open and close the gate</param>
+/// <param name="input">Holds the input samples the gate is applied to</param>
+/// <param name="cv">Receives the sample accurate CV, either the gate state or the gain curve</param>
+void Gate_RunBlock(gate_t *gate, const float *key, const float *input, float *output, float *cv,
+                   const uint32_t n_samples, const gate_cv_mode_t cvMode);
+
+/// <summary>This method called to run one Gate over linked channels, keyed by the loudest channel</summary>
+/// <param name="input">Holds the input channel pointers</param>
+/// <param name="output">Holds the output channel pointers</param>
+/// <param name="channels">Holds the number of channels, up to GATE_MAX_CHANNELS. The Gate uses a single detector window, init it for 1 channel</param>
+void Gate_RunBlockLinked(gate_t *gate, const float *const *input, float *const *output,
+                         const uint32_t channels, const uint32_t n_samples);
+
+/// <summary>This method called to only apply the Gate to the input sample</summary>
+/// <param name="input">Holds input sample</param> 
+float Gate_ApplyGate(gate_t *gate, const float input);
+
+/// <summary>This method called to select the detector used for the key</summary>
+/// <param name="mode">Holds the key mode, windowed average or peak hold of |x|</param>
+void Gate_SetKeyMode(gate_t *gate, const gate_key_mode_t mode);
+
+/// <summary>This method called to enable or disable the lookahead, needs Gate_InitLookahead</summary>
+void Gate_SetLookahead(gate_t *gate, const int enabled);
+
+/// <summary>This method called to get the current lookahead delay</summary>
+/// <returns>The latency in samples, 0 if the lookahead is disabled</returns>
+uint32_t Gate_GetLatency(gate_t *gate);
+
+/// <summary>This method called to delay a sample by the lookahead, must be called once per sample per channel</summary>
+/// <param name="channel">Holds the channel index, 0 or 1</param>
+/// <param name="input">Holds input sample</param>
+float Gate_Delay(gate_t *gate, const uint32_t channel, const float input);
+
+/// <summary>This method called to clear the detector windows, e.g. when the key source changes</summary>
+void Gate_ResetKey(gate_t *gate);
+
+/// <summary>This method called to push a mono sample to the ringbuffer</summary>
+/// <param name="input">Holds input sample</param> 
+void Gate_PushSample(gate_t *gate, const float input);
+
+/// <summary>This method called to push the stereo samples to the ringbuffer, needs 2 channels</summary>
+/// <param name="input">Holds input sample</param> 
+void Gate_PushSamples(gate_t *gate, const float input1, const float input2);
+                
+/// <summary>This method called to set the length of the window</summary>
+/// <param name="length">Holds the value that determines the window length</param>  
+void Gate_UpdateParameters(gate_t *gate, const uint32_t sampleRate, const uint32_t attack, const uint32_t hold,
+                      const uint32_t decay, const uint32_t alpha, const float upperThreshold,
+                      const float lowerThreshold);
+
+#endif //GATE_CORE_H_INCLUDED
@@ -0,0 +1,123 @@
+/*
+ * mod-system-plugins shared DSP
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// writes dsp_tables.c, runs on the build machine, so it is built with the host compiler and without
+// -ffast-math. Every table is rounded to float, then its interpolation error is measured in double
+// between the points; the build fails if it is above DSP_TABLE_MAX_ERROR.
+
+#include <stdio.h>
+#include <math.h>
+
+#include "dsp_tables.h"
+
+// points checked inside every segment
+#define GEN_ERROR_STEPS 64
+
+typedef enum {
+    GEN_ERROR_ABSOLUTE,
+    GEN_ERROR_RELATIVE,
+    GEN_ERROR_LOG2      // absolute error of a log2, stored as the relative error of the linear value
+} gen_error_t;
+
+static double gen_sine(double x) { return sin(M_PI * 0.5 * x); }
+static double gen_exp2(double x) { return exp2(x); }
+static double gen_log2(double x) { return log2(1.0 + x); }
+
+static double gen_table(float *table, double (*f)(double), gen_error_t type)
+{
+    double worst = 0.0;
+
+    for (int i = 0; i <= DSP_TABLE_SIZE; i++)
+        table[i] = (float)f((double)i / DSP_TABLE_SIZE);
+
+    for (int i = 0; i < DSP_TABLE_SIZE; i++)
+    {
+        for (int s = 0; s < GEN_ERROR_STEPS; s++)
+        {
+            const double frac = (double)s / GEN_ERROR_STEPS;
+            const double exact = f((i + frac) / DSP_TABLE_SIZE);
+            const double interpolated = table[i] + ((double)table[i + 1] - table[i]) * frac;
+            double error = fabs(interpolated - exact);
+
+            if (type == GEN_ERROR_RELATIVE)
+                error /= fabs(exact);
+            else if (type == GEN_ERROR_LOG2)
+                error *= M_LN2;
+
+            worst = error > worst ? error : worst;
+        }
+    }
+
+    return worst;
+}
+
+static void gen_write(FILE *file, const char *name, const float *table, double error)
+{
+    fprintf(file, "\nconst float %s[DSP_TABLE_SIZE + 1] = {", name);
+
+    for (int i = 0; i <= DSP_TABLE_SIZE; i++)
+        fprintf(file, "%s%.9ef,", (i % 4) ? " " : "\n    ", table[i]);
+
+    fprintf(file, "\n};\n\nconst double %s_error = %.6e;\n", name, error);
+}
+
+int main(int argc, char **argv)
+{
+    static float sine[DSP_TABLE_SIZE + 1], exp2t[DSP_TABLE_SIZE + 1], log2t[DSP_TABLE_SIZE + 1];
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s dsp_tables.c\n", argv[0]);
+        return 1;
+    }
+
+    const double errors[3] = {
+        gen_table(sine, gen_sine, GEN_ERROR_ABSOLUTE),
+        gen_table(exp2t, gen_exp2, GEN_ERROR_RELATIVE),
+        gen_table(log2t, gen_log2, GEN_ERROR_LOG2),
+    };
+    static const char *const names[3] = { "dsp_table_sine", "dsp_table_exp2", "dsp_table_log2" };
+
+    for (int t = 0; t < 3; t++)
+    {
+        if (errors[t] > DSP_TABLE_MAX_ERROR)
+        {
+            fprintf(stderr, "%s: error %e is above %e, raise DSP_TABLE_BITS\n", names[t], errors[t], DSP_TABLE_MAX_ERROR);
+            return 1;
+        }
+    }
+
+    FILE *file = fopen(argv[1], "w");
+    if (!file)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(file, "// generated by gen-tables.c, do not edit\n\n#include \"dsp_tables.h\"\n");
+    gen_write(file, names[0], sine, errors[0]);
+    gen_write(file, names[1], exp2t, errors[1]);
+    gen_write(file, names[2], log2t, errors[2]);
+
+    if (fclose(file) != 0)
+    {
+        perror(argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
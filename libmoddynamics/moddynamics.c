@@ -0,0 +1,191 @@
+/*
+ * mod-system-plugins dynamics library
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "moddynamics.h"
+
+#include "dynamics.h"
+#include "dsp_arena.h"
+#include "dsp_denormal.h"
+
+// the instance is the first piece of its own arena, the buffers of the core follow it
+
+struct moddynamics_compressor {
+    dynamics_compressor_t core;
+
+    float mode;
+    float release;
+    float volume;
+};
+
+struct moddynamics_gate {
+    dynamics_gate_t core;
+
+    float mode;
+    float threshold;
+    float decay;
+    float lookahead;
+};
+
+uint32_t moddynamics_version(void)
+{
+    return MODDYNAMICS_VERSION;
+}
+
+/*******************************************************************************
+								compressor
+*******************************************************************************/
+
+size_t moddynamics_compressor_memory_size(const uint32_t sampleRate, const uint32_t maxBlock)
+{
+    (void)sampleRate;
+
+    return DSP_CACHE_LINE + DSP_ARENA_SIZE(sizeof(moddynamics_compressor_t)) + dynamics_compressor_memory_size(maxBlock);
+}
+
+moddynamics_compressor_t *moddynamics_compressor_create(void *memory, const size_t size,
+                                                        const uint32_t sampleRate, const uint32_t maxBlock)
+{
+    dsp_arena_t arena;
+
+    if (!memory || size < moddynamics_compressor_memory_size(sampleRate, maxBlock))
+        return NULL;
+
+    dsp_arena_attach(&arena, memory, size);
+
+    moddynamics_compressor_t *comp = (moddynamics_compressor_t *)dsp_arena_alloc(&arena, sizeof(moddynamics_compressor_t));
+    if (!comp || !dynamics_compressor_init(&comp->core, sampleRate, maxBlock, &arena))
+        return NULL;
+
+    //defaults of system-compressor.ttl
+    comp->mode = DYNAMICS_COMP_LIGHT;
+    comp->release = 100.f;
+    comp->volume = 0.f;
+
+    return comp;
+}
+
+void moddynamics_compressor_destroy(moddynamics_compressor_t *comp)
+{
+    //the buffers are in the caller's memory, nothing is freed
+    dynamics_compressor_cleanup(&comp->core);
+}
+
+void moddynamics_compressor_set_param(moddynamics_compressor_t *comp, const moddynamics_compressor_param_t param,
+                                      const float value)
+{
+    switch (param)
+    {
+        case MODDYNAMICS_COMPRESSOR_MODE:
+            comp->mode = value;
+        break;
+
+        case MODDYNAMICS_COMPRESSOR_RELEASE:
+            comp->release = value;
+        break;
+
+        case MODDYNAMICS_COMPRESSOR_VOLUME:
+            comp->volume = value;
+        break;
+    }
+}
+
+void moddynamics_compressor_process(moddynamics_compressor_t *comp, const float *const *inputs, float *const *outputs,
+                                    const uint32_t frames)
+{
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
+
+    dynamics_compressor_run(&comp->core, inputs[0], inputs[1], outputs[0], outputs[1], frames,
+                            comp->mode, comp->release, comp->volume);
+
+    dsp_denormals_restore(fpmode);
+}
+
+/*******************************************************************************
+								noisegate
+*******************************************************************************/
+
+size_t moddynamics_gate_memory_size(const uint32_t sampleRate)
+{
+    return DSP_CACHE_LINE + DSP_ARENA_SIZE(sizeof(moddynamics_gate_t)) + dynamics_gate_memory_size(sampleRate);
+}
+
+moddynamics_gate_t *moddynamics_gate_create(void *memory, const size_t size, const uint32_t sampleRate)
+{
+    dsp_arena_t arena;
+
+    if (!memory || size < moddynamics_gate_memory_size(sampleRate))
+        return NULL;
+
+    dsp_arena_attach(&arena, memory, size);
+
+    moddynamics_gate_t *gate = (moddynamics_gate_t *)dsp_arena_alloc(&arena, sizeof(moddynamics_gate_t));
+    if (!gate || !dynamics_gate_init(&gate->core, sampleRate, &arena))
+        return NULL;
+
+    //defaults of system-noisegate.ttl
+    gate->mode = DYNAMICS_GATE_STEREO;
+    gate->threshold = -60.f;
+    gate->decay = 10.f;
+    gate->lookahead = 0.f;
+
+    return gate;
+}
+
+void moddynamics_gate_destroy(moddynamics_gate_t *gate)
+{
+    //the windows and delay lines are in the caller's memory, nothing is freed
+    dynamics_gate_cleanup(&gate->core);
+}
+
+void moddynamics_gate_set_param(moddynamics_gate_t *gate, const moddynamics_gate_param_t param, const float value)
+{
+    switch (param)
+    {
+        case MODDYNAMICS_GATE_MODE:
+            gate->mode = value;
+        break;
+
+        case MODDYNAMICS_GATE_THRESHOLD:
+            gate->threshold = value;
+        break;
+
+        case MODDYNAMICS_GATE_DECAY:
+            gate->decay = value;
+        break;
+
+        case MODDYNAMICS_GATE_LOOKAHEAD:
+            gate->lookahead = value;
+        break;
+    }
+}
+
+uint32_t moddynamics_gate_latency(moddynamics_gate_t *gate)
+{
+    //an empty block applies the parameters, the next process would do the same first
+    return dynamics_gate_run(&gate->core, NULL, NULL, NULL, NULL, 0,
+                             gate->mode, gate->threshold, gate->decay, gate->lookahead);
+}
+
+void moddynamics_gate_process(moddynamics_gate_t *gate, const float *const *inputs, float *const *outputs,
+                              const uint32_t frames)
+{
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
+
+    dynamics_gate_run(&gate->core, inputs[0], inputs[1], outputs[0], outputs[1], frames,
+                      gate->mode, gate->threshold, gate->decay, gate->lookahead);
+
+    dsp_denormals_restore(fpmode);
+}
@@ -0,0 +1,119 @@
+/*
+ * mod-system-plugins dynamics library
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef MODDYNAMICS_H_INCLUDED
+#define MODDYNAMICS_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The system compressor and system noisegate for hosts that run them inline, without LV2.
+// They sound exactly like the system-compressor and system-noisegate plugins with the same controls.
+//
+// An instance lives in memory the caller provides, sized by the *_memory_size functions, so
+// *_create and *_destroy never allocate and may be called from the audio thread. Instances are not
+// thread safe: set the parameters from the thread that processes, e.g. at the top of the process
+// callback. Buffers are non-interleaved, one array of channel pointers in and one out, and the
+// outputs may be the inputs.
+
+#define MODDYNAMICS_VERSION_MAJOR 1
+#define MODDYNAMICS_VERSION_MINOR 0
+#define MODDYNAMICS_VERSION_MICRO 0
+
+#define MODDYNAMICS_VERSION \
+    ((MODDYNAMICS_VERSION_MAJOR << 16) | (MODDYNAMICS_VERSION_MINOR << 8) | MODDYNAMICS_VERSION_MICRO)
+
+// channels of both processors
+#define MODDYNAMICS_CHANNELS 2
+
+typedef struct moddynamics_compressor moddynamics_compressor_t;
+typedef struct moddynamics_gate moddynamics_gate_t;
+
+// compressor parameters, in the units of the system-compressor controls
+typedef enum {
+    MODDYNAMICS_COMPRESSOR_MODE,        // 0 bypass, 1 light, 2 medium, 3 heavy, 4 extreme, default 1
+    MODDYNAMICS_COMPRESSOR_RELEASE,     // ms, 50 to 500, default 100
+    MODDYNAMICS_COMPRESSOR_VOLUME       // master volume in dB, -30 to 20, default 0
+} moddynamics_compressor_param_t;
+
+// noisegate parameters, in the units of the system-noisegate controls
+typedef enum {
+    MODDYNAMICS_GATE_MODE,              // 0 off, 1 channel 1, 2 channel 2, 3 stereo, default 3
+    MODDYNAMICS_GATE_THRESHOLD,         // dB, -70 to -10, default -60, the gate closes 20dB below it
+    MODDYNAMICS_GATE_DECAY,             // ms, 1 to 500, default 10
+    MODDYNAMICS_GATE_LOOKAHEAD          // 0 off, 1 on, default 0, adds moddynamics_gate_latency
+} moddynamics_gate_param_t;
+
+/// <summary>This method called to get the version the library was built as, see MODDYNAMICS_VERSION</summary>
+/// <returns>The version, the major in bits 16 to 23, a host should refuse a different major</returns>
+uint32_t moddynamics_version(void);
+
+/// <summary>This method called to get the memory a compressor needs, with room to align it</summary>
+/// <param name="maxBlock">Holds the longest block moddynamics_compressor_process gets without slicing it</param>
+size_t moddynamics_compressor_memory_size(const uint32_t sampleRate, const uint32_t maxBlock);
+
+/// <summary>This method called to create a compressor with default parameters inside memory, allocates nothing</summary>
+/// <param name="memory">Holds at least moddynamics_compressor_memory_size bytes, any alignment, owned by the caller</param>
+/// <returns>The compressor, or NULL if size is too small</returns>
+moddynamics_compressor_t *moddynamics_compressor_create(void *memory, const size_t size,
+                                                        const uint32_t sampleRate, const uint32_t maxBlock);
+
+/// <summary>This method called to end a compressor, its memory can be reused or freed by the caller afterwards</summary>
+void moddynamics_compressor_destroy(moddynamics_compressor_t *comp);
+
+/// <summary>This method called to set a compressor parameter, it applies from the next block</summary>
+void moddynamics_compressor_set_param(moddynamics_compressor_t *comp, const moddynamics_compressor_param_t param,
+                                      const float value);
+
+/// <summary>This method called to compress a stereo block</summary>
+/// <param name="inputs">Holds MODDYNAMICS_CHANNELS channel pointers</param>
+/// <param name="outputs">Holds MODDYNAMICS_CHANNELS channel pointers, which may be the inputs</param>
+void moddynamics_compressor_process(moddynamics_compressor_t *comp, const float *const *inputs, float *const *outputs,
+                                    const uint32_t frames);
+
+/// <summary>This method called to get the memory a noisegate needs, with room to align it</summary>
+size_t moddynamics_gate_memory_size(const uint32_t sampleRate);
+
+/// <summary>This method called to create a noisegate with default parameters inside memory, allocates nothing</summary>
+/// <param name="memory">Holds at least moddynamics_gate_memory_size bytes, any alignment, owned by the caller</param>
+/// <returns>The noisegate, or NULL if size is too small</returns>
+moddynamics_gate_t *moddynamics_gate_create(void *memory, const size_t size, const uint32_t sampleRate);
+
+/// <summary>This method called to end a noisegate, its memory can be reused or freed by the caller afterwards</summary>
+void moddynamics_gate_destroy(moddynamics_gate_t *gate);
+
+/// <summary>This method called to set a noisegate parameter, it applies from the next block</summary>
+void moddynamics_gate_set_param(moddynamics_gate_t *gate, const moddynamics_gate_param_t param, const float value);
+
+/// <summary>This method called to get the delay of the output with the current parameters</summary>
+/// <returns>The latency in frames, 0 unless MODDYNAMICS_GATE_LOOKAHEAD is on</returns>
+uint32_t moddynamics_gate_latency(moddynamics_gate_t *gate);
+
+/// <summary>This method called to gate a stereo block</summary>
+/// <param name="inputs">Holds MODDYNAMICS_CHANNELS channel pointers</param>
+/// <param name="outputs">Holds MODDYNAMICS_CHANNELS channel pointers, which may be the inputs</param>
+void moddynamics_gate_process(moddynamics_gate_t *gate, const float *const *inputs, float *const *outputs,
+                              const uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MODDYNAMICS_H_INCLUDED
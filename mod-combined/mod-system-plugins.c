@@ -0,0 +1,42 @@
+/*
+ * mod-system-plugins combined bundle
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// one binary for the four system plugins, each source is compiled with PLUGIN_COMBINED
+// so it hands its descriptor over here instead of exporting lv2_descriptor itself
+
+#include <stddef.h>
+
+#include "lv2/lv2plug.in/ns/lv2core/lv2.h"
+
+const LV2_Descriptor* system_compressor_descriptor(void);
+const LV2_Descriptor* advanced_compressor_descriptor(void);
+const LV2_Descriptor* system_noisegate_descriptor(void);
+const LV2_Descriptor* advanced_noisegate_descriptor(void);
+
+/**********************************************************************************************************************************************************/
+LV2_SYMBOL_EXPORT
+const LV2_Descriptor* lv2_descriptor(uint32_t index)
+{
+    switch (index)
+    {
+        case 0: return system_compressor_descriptor();
+        case 1: return advanced_compressor_descriptor();
+        case 2: return system_noisegate_descriptor();
+        case 3: return advanced_noisegate_descriptor();
+        default: return NULL;
+    }
+}
+/**********************************************************************************************************************************************************/
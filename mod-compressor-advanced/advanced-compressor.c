@@ -26,6 +26,8 @@
 #include "lv2/lv2plug.in/ns/ext/uri-map/uri-map.h"
 
 #include "compressor_core.h"
+#include "dsp_arena.h"
+#include "dsp_denormal.h"
 
 /**********************************************************************************************************************************************************/
 
@@ -70,6 +72,7 @@ typedef struct{
 
     float *bfr_l;
     float *bfr_r;
+    uint32_t bfr_size;
 
     float prev_threshold;
     float prev_knee;
@@ -82,7 +85,10 @@ typedef struct{
 
     const LV2_URID_Map* urid_map;
 
-    sf_compressor_state_st compressor_state;
+    // holds this struct and the buffers
+    dsp_arena_t arena;
+
+    sf_compressor_state_st compressor_state DSP_CACHE_ALIGNED;
 
 } Compressor;
 
@@ -97,25 +103,24 @@ double                              samplerate,
 const char*                         bundle_path,
 const LV2_Feature* const* features)
 {
-    Compressor* self = (Compressor*)malloc(sizeof(Compressor));
-
     // query host features
     const LV2_Options_Option* options = NULL;
+    const LV2_URID_Map* urid_map = NULL;
     for (int i=0; features[i] != NULL; ++i)
     {
         if (strcmp(features[i]->URI, LV2_OPTIONS__options) == 0)
             options = (const LV2_Options_Option*)features[i]->data;
         else if (strcmp(features[i]->URI, LV2_URID__map) == 0)
-            self->urid_map = (const LV2_URID_Map*)features[i]->data;
+            urid_map = (const LV2_URID_Map*)features[i]->data;
     }
 
     // find max block length
     int maxBufSize = COMP_BUF_SIZE;
     for (int i=0; options[i].key != 0; ++i)
     {
-        if (options[i].key == self->urid_map->map(self->urid_map->handle, LV2_BUF_SIZE__maxBlockLength))
+        if (options[i].key == urid_map->map(urid_map->handle, LV2_BUF_SIZE__maxBlockLength))
         {
-            if (options[i].type == self->urid_map->map(self->urid_map->handle, LV2_ATOM__Int))
+            if (options[i].type == urid_map->map(urid_map->handle, LV2_ATOM__Int))
             {
                 maxBufSize = *(const int*)options[i].value;
                 break;
@@ -124,11 +129,27 @@ const LV2_Feature* const* features)
         }
     }
 
-    self->bfr_l = (float*)malloc(maxBufSize*sizeof(float));
-    self->bfr_r = (float*)malloc(maxBufSize*sizeof(float));
+    if (maxBufSize < 1)
+        maxBufSize = COMP_BUF_SIZE;
+
+    dsp_arena_t arena;
+    if (!dsp_arena_init(&arena, DSP_ARENA_SIZE(sizeof(Compressor)) + 2 * DSP_ARENA_SIZE(maxBufSize*sizeof(float))))
+        return NULL;
+
+    Compressor* self = (Compressor*)dsp_arena_alloc(&arena, sizeof(Compressor));
+    self->arena = arena;
+    self->urid_map = urid_map;
+
+    self->bfr_size = maxBufSize;
+    self->bfr_l = (float*)dsp_arena_alloc(&self->arena, maxBufSize*sizeof(float));
+    self->bfr_r = (float*)dsp_arena_alloc(&self->arena, maxBufSize*sizeof(float));
 
     compressor_init(&self->compressor_state, samplerate);
 
+#ifdef DSP_STATS
+    self->compressor_state.stats = dsp_stats_open(PLUGIN_URI, (uint32_t)samplerate);
+#endif
+
     // invalid initial values
     self->prev_threshold = self->prev_knee = self->prev_attack = self->prev_release = self->prev_ratio = -9999;
     self->prev_makeup = self->linear_volume = 1.f;
@@ -177,15 +198,17 @@ static void connect_port(LV2_Handle instance, uint32_t port, void *data)
     }
 }
 /**********************************************************************************************************************************************************/
-void activate(LV2_Handle instance)
+static void activate(LV2_Handle instance)
 {
     // TODO: include the activate function code here
 }
 
 /**********************************************************************************************************************************************************/
-void run(LV2_Handle instance, uint32_t n_samples)
+static void run(LV2_Handle instance, uint32_t n_samples)
 {
     Compressor* self = (Compressor*)instance;    
+    DSP_STATS_RUN_BEGIN(stats_start);
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
 
     if ((self->prev_threshold != (float)*self->threshold) || (self->prev_knee != (float)*self->knee) || (self->prev_attack != (float)*self->attack) || (self->prev_release != (float)*self->release) || (self->prev_ratio != (float)*self->ratio) || (self->prev_makeup != (float)*self->makeup) )
     {
@@ -202,30 +225,40 @@ void run(LV2_Handle instance, uint32_t n_samples)
         self->linear_volume = cmop_db2lin((float)*self->makeup);
     }
 
-    compressor_process(&self->compressor_state, n_samples, self->input_left, self->input_right, self->bfr_l, self->bfr_r);
+    //the buffers hold maxBlockLength samples, slices only happen for hosts running larger blocks
+    for (uint32_t offset = 0; offset < n_samples; offset += self->bfr_size) {
+        const uint32_t n = (n_samples - offset < self->bfr_size) ? n_samples - offset : self->bfr_size;
+
+        compressor_process(&self->compressor_state, n, self->input_left + offset, self->input_right + offset, self->bfr_l, self->bfr_r);
 
-    for (uint32_t i = 0; i < n_samples; i++) {
-        self->output_left[i] = self->bfr_l[i] * self->linear_volume;
-        self->output_right[i] = self->bfr_r[i] * self->linear_volume;
+        for (uint32_t i = 0; i < n; i++) {
+            self->output_left[offset + i] = self->bfr_l[i] * self->linear_volume;
+            self->output_right[offset + i] = self->bfr_r[i] * self->linear_volume;
+        }
     }
+
+    dsp_telemetry_publish(&self->compressor_state.telemetry, n_samples);
+    DSP_STATS_RUN_END(self->compressor_state.stats, stats_start, n_samples);
+    dsp_denormals_restore(fpmode);
 }
 
 /**********************************************************************************************************************************************************/
-void deactivate(LV2_Handle instance)
+static void deactivate(LV2_Handle instance)
 {
     // TODO: include the deactivate function code here
 }
 /**********************************************************************************************************************************************************/
-void cleanup(LV2_Handle instance)
+static void cleanup(LV2_Handle instance)
 {
     Compressor* self = (Compressor*)instance;
 
-    free(self->bfr_l);
-    free(self->bfr_r);
-    free(self);
+#ifdef DSP_STATS
+    dsp_stats_close(self->compressor_state.stats);
+#endif
+    dsp_arena_free(&self->arena);
 }
 /**********************************************************************************************************************************************************/
-uint32_t set_options(LV2_Handle instance, const LV2_Options_Option* options)
+static uint32_t set_options(LV2_Handle instance, const LV2_Options_Option* options)
 {
     Compressor* self = (Compressor*)instance;
 
@@ -234,20 +267,28 @@ uint32_t set_options(LV2_Handle instance, const LV2_Options_Option* options)
         if (options[i].key != self->urid_map->map(self->urid_map->handle, LV2_BUF_SIZE__nominalBlockLength))
             continue;
 
-        const int maxBufSize = *(const int*)options[i].value;
-
-        free(self->bfr_l);
-        free(self->bfr_r);
-        self->bfr_l = (float*)malloc(maxBufSize*sizeof(float));
-        self->bfr_r = (float*)malloc(maxBufSize*sizeof(float));
+        // the buffers are sized for maxBlockLength in instantiate, which no nominalBlockLength exceeds,
+        // so nothing is reallocated while the plugin may already be running
         return LV2_OPTIONS_SUCCESS;
     }
 
     return LV2_OPTIONS_ERR_UNKNOWN;
 }
 /**********************************************************************************************************************************************************/
-const void* extension_data(const char* uri)
+static int telemetry_read(void* instance, dsp_telemetry_values_t* values, int restart)
 {
+    Compressor* self = (Compressor*)instance;
+
+    return dsp_telemetry_read(&self->compressor_state.telemetry, values, restart);
+}
+/**********************************************************************************************************************************************************/
+static const void* extension_data(const char* uri)
+{
+    if (strcmp(uri, DSP_TELEMETRY__interface) == 0)
+    {
+        static const dsp_telemetry_interface_t telemetry = { telemetry_read };
+        return &telemetry;
+    }
     if (strcmp(uri, LV2_OPTIONS__interface) == 0)
     {
         static const LV2_Options_Interface options = { NULL, set_options };
@@ -267,10 +308,18 @@ static const LV2_Descriptor Descriptor = {
     extension_data
 };
 /**********************************************************************************************************************************************************/
+#ifdef PLUGIN_COMBINED
+//the combined bundle in mod-combined exports all system plugins from one binary
+const LV2_Descriptor* advanced_compressor_descriptor(void)
+{
+    return &Descriptor;
+}
+#else
 LV2_SYMBOL_EXPORT
 const LV2_Descriptor* lv2_descriptor(uint32_t index)
 {
     if (index == 0) return &Descriptor;
     else return NULL;
 }
+#endif
 /**********************************************************************************************************************************************************/
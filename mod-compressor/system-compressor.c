@@ -25,7 +25,8 @@
 #include "lv2/lv2plug.in/ns/ext/options/options.h"
 #include "lv2/lv2plug.in/ns/ext/uri-map/uri-map.h"
 
-#include "compressor_core.h"
+#include "dynamics.h"
+#include "dsp_denormal.h"
 
 /**********************************************************************************************************************************************************/
 
@@ -33,11 +34,8 @@
 
 #define MAP(x, Imin, Imax, Omin, Omax)      ( x - Imin ) * (Omax -  Omin)  / (Imax - Imin) + Omin;
 
-#define COMP_BUF_SIZE 256
 #define SAMPLERATE 48000
 
-#define DEZIPPER_CONSTANT  0.1
-
 typedef enum {
     INPUT_L,
     INPUT_R,
@@ -63,16 +61,13 @@ typedef struct{
 
     float* volume;
 
-    float *bfr_l;
-    float *bfr_r;
-
-    float prev_release;
-    float prev_mode;
-    float prev_volume;
-
     const LV2_URID_Map* urid_map;
 
-    sf_compressor_state_st compressor_state;
+    // holds this struct and the buffers
+    dsp_arena_t arena;
+
+    // presets, volume dezipper and the compressor state, see dsp/dynamics.h
+    dynamics_compressor_t compressor;
 
 } Compressor;
 
@@ -87,25 +82,24 @@ double                              samplerate,
 const char*                         bundle_path,
 const LV2_Feature* const* features)
 {
-    Compressor* self = (Compressor*)malloc(sizeof(Compressor));
-
     // query host features
     const LV2_Options_Option* options = NULL;
+    const LV2_URID_Map* urid_map = NULL;
     for (int i=0; features[i] != NULL; ++i)
     {
         if (strcmp(features[i]->URI, LV2_OPTIONS__options) == 0)
             options = (const LV2_Options_Option*)features[i]->data;
         else if (strcmp(features[i]->URI, LV2_URID__map) == 0)
-            self->urid_map = (const LV2_URID_Map*)features[i]->data;
+            urid_map = (const LV2_URID_Map*)features[i]->data;
     }
 
     // find max block length
-    int maxBufSize = COMP_BUF_SIZE;
+    int maxBufSize = DYNAMICS_COMP_BLOCK;
     for (int i=0; options[i].key != 0; ++i)
     {
-        if (options[i].key == self->urid_map->map(self->urid_map->handle, LV2_BUF_SIZE__maxBlockLength))
+        if (options[i].key == urid_map->map(urid_map->handle, LV2_BUF_SIZE__maxBlockLength))
         {
-            if (options[i].type == self->urid_map->map(self->urid_map->handle, LV2_ATOM__Int))
+            if (options[i].type == urid_map->map(urid_map->handle, LV2_ATOM__Int))
             {
                 maxBufSize = *(const int*)options[i].value;
                 break;
@@ -113,15 +107,26 @@ const LV2_Feature* const* features)
             break;
         }
     }
+    if (maxBufSize < 1)
+        maxBufSize = DYNAMICS_COMP_BLOCK;
 
-    self->bfr_l = (float*)malloc(maxBufSize*sizeof(float));
-    self->bfr_r = (float*)malloc(maxBufSize*sizeof(float));
+    dsp_arena_t arena;
+    if (!dsp_arena_init(&arena, DSP_ARENA_SIZE(sizeof(Compressor)) + dynamics_compressor_memory_size(maxBufSize)))
+        return NULL;
 
-    compressor_init(&self->compressor_state, samplerate);
+    Compressor* self = (Compressor*)dsp_arena_alloc(&arena, sizeof(Compressor));
+    self->arena = arena;
+    self->urid_map = urid_map;
 
-    // invalid initial values
-    self->prev_release = self->prev_mode = -9999;
-    self->prev_volume = 1.f;
+    if (!dynamics_compressor_init(&self->compressor, (uint32_t)samplerate, maxBufSize, &self->arena))
+    {
+        dsp_arena_free(&self->arena);
+        return NULL;
+    }
+
+#ifdef DSP_STATS
+    self->compressor.state.stats = dsp_stats_open(PLUGIN_URI, (uint32_t)samplerate);
+#endif
 
     return (LV2_Handle)self;
 }
@@ -158,115 +163,67 @@ static void connect_port(LV2_Handle instance, uint32_t port, void *data)
     }
 }
 /**********************************************************************************************************************************************************/
-void activate(LV2_Handle instance)
+static void activate(LV2_Handle instance)
 {
     // TODO: include the activate function code here
 }
 
 /**********************************************************************************************************************************************************/
-void run(LV2_Handle instance, uint32_t n_samples)
+static void run(LV2_Handle instance, uint32_t n_samples)
 {
     Compressor* self = (Compressor*)instance;    
+    DSP_STATS_RUN_BEGIN(stats_start);
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
 
-    if ((self->prev_release!= (float)*self->release) || (self->prev_mode != (float)*self->mode)) {
-        switch((int)*self->mode)
-        {
-            //light compression
-            case 1:
-                compressor_set_params(&self->compressor_state, -12.f,
-                                        12.f, 2.f, 0.0001f, ((float)*self->release/1000), -3.f);
-            break;
-
-            //medium compression
-            case 2:
-                compressor_set_params(&self->compressor_state, -12.f,
-                                        12.f, 3.f, 0.0001f, ((float)*self->release/1000), -3.f);
-            break;
-
-            //heavy compression
-            case 3:
-                compressor_set_params(&self->compressor_state, -15.f,
-                                        15.f, 4.f, 0.0001f, ((float)*self->release/1000), -3.f);
-            break;
-
-            //extreme compression
-            case 4:
-            default:
-                compressor_set_params(&self->compressor_state, -25.f,
-                                        15.f, 10.f, 0.0001f, ((float)*self->release/1000), -6.f);
-            break;
-        }
+    dynamics_compressor_run(&self->compressor, self->input_left, self->input_right, self->output_left, self->output_right,
+                            n_samples, (float)*self->mode, (float)*self->release, (float)*self->volume);
 
-        self->prev_release = (float)*self->release;
-        self->prev_mode = (float)*self->mode;
-    }
-
-    float linear_volume = cmop_db2lin((float)*self->volume);
-
-    if ((int)*self->mode != 0)
-    {
-        compressor_process(&self->compressor_state, n_samples, self->input_left, self->input_right, self->bfr_l, self->bfr_r);
-    
-        for (uint32_t i = 0; i < n_samples; i++) {
-            //moving average over volume, reduces zipper noise
-            if (self->prev_volume != linear_volume)
-                self->prev_volume = DEZIPPER_CONSTANT * linear_volume + (1.0 - DEZIPPER_CONSTANT) * self->prev_volume;
-
-            self->output_left[i] = self->bfr_l[i] * self->prev_volume;
-            self->output_right[i] = self->bfr_r[i] * self->prev_volume;
-        }
-    }
-    else
-    {
-        for (uint32_t i = 0; i < n_samples; i++) {
-            //moving average over volume, reduces zipper noise
-            if (self->prev_volume != linear_volume)
-                self->prev_volume = DEZIPPER_CONSTANT * linear_volume + (1.0 - DEZIPPER_CONSTANT) * self->prev_volume;
-
-            self->output_left[i] = self->input_left[i] * self->prev_volume;
-            self->output_right[i] = self->input_right[i] * self->prev_volume;
-        }
-    }
+    dsp_telemetry_publish(&self->compressor.state.telemetry, n_samples);
+    DSP_STATS_RUN_END(self->compressor.state.stats, stats_start, n_samples);
+    dsp_denormals_restore(fpmode);
 }
 
 /**********************************************************************************************************************************************************/
-void deactivate(LV2_Handle instance)
+static void deactivate(LV2_Handle instance)
 {
     // TODO: include the deactivate function code here
 }
 /**********************************************************************************************************************************************************/
-void cleanup(LV2_Handle instance)
+static void cleanup(LV2_Handle instance)
 {
     Compressor* self = (Compressor*)instance;
 
-    free(self->bfr_l);
-    free(self->bfr_r);
-    free(self);
+#ifdef DSP_STATS
+    dsp_stats_close(self->compressor.state.stats);
+#endif
+    dynamics_compressor_cleanup(&self->compressor);
+    dsp_arena_free(&self->arena);
 }
 /**********************************************************************************************************************************************************/
-uint32_t set_options(LV2_Handle instance, const LV2_Options_Option* options)
+static uint32_t set_options(LV2_Handle instance, const LV2_Options_Option* options)
 {
-    Compressor* self = (Compressor*)instance;
-
-    for (int i=0; options[i].key != 0; ++i)
-    {
-        if (options[i].key != self->urid_map->map(self->urid_map->handle, LV2_BUF_SIZE__nominalBlockLength))
-            continue;
-
-        const int maxBufSize = *(const int*)options[i].value;
-
-        free(self->bfr_l);
-        free(self->bfr_r);
-        self->bfr_l = (float*)malloc(maxBufSize*sizeof(float));
-        self->bfr_r = (float*)malloc(maxBufSize*sizeof(float));
-        break;
-    }
+    // the buffers are sized for maxBlockLength in instantiate, which no nominalBlockLength exceeds,
+    // so nothing is reallocated while the plugin may already be running
+    (void)instance;
+    (void)options;
 
     return 0;
 }
 /**********************************************************************************************************************************************************/
-const void* extension_data(const char* uri)
+static int telemetry_read(void* instance, dsp_telemetry_values_t* values, int restart)
+{
+    Compressor* self = (Compressor*)instance;
+
+    return dsp_telemetry_read(&self->compressor.state.telemetry, values, restart);
+}
+/**********************************************************************************************************************************************************/
+static const void* extension_data(const char* uri)
 {
+    if (strcmp(uri, DSP_TELEMETRY__interface) == 0)
+    {
+        static const dsp_telemetry_interface_t telemetry = { telemetry_read };
+        return &telemetry;
+    }
     if (strcmp(uri, LV2_OPTIONS__interface) == 0)
     {
         static const LV2_Options_Interface options = { NULL, set_options };
@@ -286,10 +243,18 @@ static const LV2_Descriptor Descriptor = {
     extension_data
 };
 /**********************************************************************************************************************************************************/
+#ifdef PLUGIN_COMBINED
+//the combined bundle in mod-combined exports all system plugins from one binary
+const LV2_Descriptor* system_compressor_descriptor(void)
+{
+    return &Descriptor;
+}
+#else
 LV2_SYMBOL_EXPORT
 const LV2_Descriptor* lv2_descriptor(uint32_t index)
 {
     if (index == 0) return &Descriptor;
     else return NULL;
 }
+#endif
 /**********************************************************************************************************************************************************/
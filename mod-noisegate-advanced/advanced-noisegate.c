@@ -22,11 +22,16 @@
 #include "lv2/lv2plug.in/ns/lv2core/lv2.h"
 
 #include "gate_core.h"
+#include "dsp_arena.h"
+#include "dsp_denormal.h"
 
 /**********************************************************************************************************************************************************/
 
 #define PLUGIN_URI "http://moddevices.com/plugins/mod-devel/Advanced-NoiseGate"
 
+// maximum of the attack port, sizes the lookahead
+#define MAX_ATTACK_TIME 100
+
 typedef enum {
     PLUGIN_INPUT,
     PLUGIN_KEY,
@@ -35,7 +40,11 @@ typedef enum {
     PLUGIN_ATTACK,
     PLUGIN_HOLD,
     PLUGIN_DECAY,
-    PLUGIN_CVOUT
+    PLUGIN_CVOUT,
+    PLUGIN_KEY_MODE,
+    PLUGIN_CV_MODE,
+    PLUGIN_LOOKAHEAD,
+    PLUGIN_LATENCY
 }PortIndex;
 
 /**********************************************************************************************************************************************************/
@@ -51,10 +60,17 @@ typedef struct{
     float*             hold;
     float*            decay;
     float*            CVout;
+    float*         key_mode;
+    float*          cv_mode;
+    float*        lookahead;
+    float*          latency;
 
     uint32_t     sampleRate;
 
-    gate_t noisegate;
+    // holds this struct and the gate buffers
+    dsp_arena_t arena;
+
+    gate_t noisegate DSP_CACHE_ALIGNED;
 
 } NoiseGate;
 
@@ -69,11 +85,35 @@ double                              samplerate,
 const char*                         bundle_path,
 const LV2_Feature* const* features)
 {
-    NoiseGate* self = (NoiseGate*)malloc(sizeof(NoiseGate));
+    const uint32_t sampleRate = (uint32_t)samplerate;
+    const uint32_t decimation = Gate_KeyDecimation(sampleRate);
+
+    dsp_arena_t arena;
+    if (!dsp_arena_init(&arena, DSP_ARENA_SIZE(sizeof(NoiseGate))
+                        + Gate_MemorySize(sampleRate, GATE_DEFAULT_WINDOW_MS, 1, decimation, MAX_ATTACK_TIME)))
+        return NULL;
+
+    NoiseGate* self = (NoiseGate*)dsp_arena_alloc(&arena, sizeof(NoiseGate));
+    self->arena = arena;
+
+    self->sampleRate = sampleRate;
+
+    if (!Gate_Init(&self->noisegate, self->sampleRate, GATE_DEFAULT_WINDOW_MS, 1,
+                   decimation, &self->arena))
+    {
+        dsp_arena_free(&self->arena);
+        return NULL;
+    }
 
-    self->sampleRate = (uint32_t)samplerate;
+    if (!Gate_InitLookahead(&self->noisegate, self->sampleRate, MAX_ATTACK_TIME, &self->arena))
+    {
+        dsp_arena_free(&self->arena);
+        return NULL;
+    }
 
-    Gate_Init(&self->noisegate);
+#ifdef DSP_STATS
+    self->noisegate.stats = dsp_stats_open(PLUGIN_URI, self->sampleRate);
+#endif
 
     return (LV2_Handle)self;
 }
@@ -108,18 +148,32 @@ static void connect_port(LV2_Handle instance, uint32_t port, void *data)
         case PLUGIN_CVOUT:
             self->CVout = (float*) data;
             break;
+        case PLUGIN_KEY_MODE:
+            self->key_mode = (float*) data;
+            break;
+        case PLUGIN_CV_MODE:
+            self->cv_mode = (float*) data;
+            break;
+        case PLUGIN_LOOKAHEAD:
+            self->lookahead = (float*) data;
+            break;
+        case PLUGIN_LATENCY:
+            self->latency = (float*) data;
+            break;
     }
 }
 /**********************************************************************************************************************************************************/
-void activate(LV2_Handle instance)
+static void activate(LV2_Handle instance)
 {
     // TODO: include the activate function code here
 }
 
 /**********************************************************************************************************************************************************/
-void run(LV2_Handle instance, uint32_t n_samples)
+static void run(LV2_Handle instance, uint32_t n_samples)
 {
     NoiseGate* self = (NoiseGate*)instance;    
+    DSP_STATS_RUN_BEGIN(stats_start);
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
 
     //update parameters
     //lower threshold is 20dB lower
@@ -127,30 +181,51 @@ void run(LV2_Handle instance, uint32_t n_samples)
                          (uint32_t)*self->attack, (uint32_t)*self->hold,
                          (uint32_t)*self->decay, 1, *self->threshold, *self->threshold - 20.0f);
 
+    Gate_SetKeyMode(&self->noisegate, ((int)*self->key_mode == 1) ? GATE_KEY_PEAK : GATE_KEY_AVERAGE);
+    Gate_SetLookahead(&self->noisegate, *self->lookahead > 0.5f);
 
-    float cv_value = (self->noisegate._gainFactor == 0) ? 0 : 10;
+    if (self->latency)
+        *self->latency = (float)Gate_GetLatency(&self->noisegate);
 
-    for (uint32_t i = 0; i < n_samples; ++i)
-    {
-        Gate_PushSamples(&self->noisegate, self->key[i], 0.f);
-        self->output[i] = Gate_RunGate(&self->noisegate, self->input[i]);
-        self->CVout[i] = cv_value;
-    }
+    Gate_RunBlock(&self->noisegate, self->key, self->input, self->output, self->CVout, n_samples,
+                  ((int)*self->cv_mode == 1) ? GATE_CV_GAIN : GATE_CV_STATE);
+
+    dsp_telemetry_publish(&self->noisegate.telemetry, n_samples);
+    DSP_STATS_RUN_END(self->noisegate.stats, stats_start, n_samples);
+    dsp_denormals_restore(fpmode);
 }
 
 /**********************************************************************************************************************************************************/
-void deactivate(LV2_Handle instance)
+static void deactivate(LV2_Handle instance)
 {
     // TODO: include the deactivate function code here
 }
 /**********************************************************************************************************************************************************/
-void cleanup(LV2_Handle instance)
+static void cleanup(LV2_Handle instance)
+{
+    NoiseGate* self = (NoiseGate*)instance;
+
+#ifdef DSP_STATS
+    dsp_stats_close(self->noisegate.stats);
+#endif
+    Gate_Cleanup(&self->noisegate);
+    dsp_arena_free(&self->arena);
+}
+/**********************************************************************************************************************************************************/
+static int telemetry_read(void* instance, dsp_telemetry_values_t* values, int restart)
 {
-    free(instance);
+    NoiseGate* self = (NoiseGate*)instance;
+
+    return dsp_telemetry_read(&self->noisegate.telemetry, values, restart);
 }
 /**********************************************************************************************************************************************************/
-const void* extension_data(const char* uri)
+static const void* extension_data(const char* uri)
 {
+    if (strcmp(uri, DSP_TELEMETRY__interface) == 0)
+    {
+        static const dsp_telemetry_interface_t telemetry = { telemetry_read };
+        return &telemetry;
+    }
     return NULL;
 }
 /**********************************************************************************************************************************************************/
@@ -165,10 +240,18 @@ static const LV2_Descriptor Descriptor = {
     extension_data
 };
 /**********************************************************************************************************************************************************/
+#ifdef PLUGIN_COMBINED
+//the combined bundle in mod-combined exports all system plugins from one binary
+const LV2_Descriptor* advanced_noisegate_descriptor(void)
+{
+    return &Descriptor;
+}
+#else
 LV2_SYMBOL_EXPORT
 const LV2_Descriptor* lv2_descriptor(uint32_t index)
 {
     if (index == 0) return &Descriptor;
     else return NULL;
 }
+#endif
 /**********************************************************************************************************************************************************/
@@ -0,0 +1,213 @@
+/*
+ * VeJa NoiseGate
+ * Copyright (C) 2022 Jan Janssen <veja.plugins@gmail.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include "lv2/lv2plug.in/ns/lv2core/lv2.h"
+
+#include "gate_core.h"
+#include "dsp_arena.h"
+#include "dsp_denormal.h"
+
+/**********************************************************************************************************************************************************/
+
+// linked multichannel variant of the system noise gate, built once per channel count
+#ifndef GATE_CHANNELS
+#define GATE_CHANNELS 4
+#endif
+
+#if GATE_CHANNELS > GATE_MAX_CHANNELS
+#error "GATE_CHANNELS is larger than GATE_MAX_CHANNELS"
+#endif
+
+#define STRINGIFY2(x) #x
+#define STRINGIFY(x) STRINGIFY2(x)
+
+#define PLUGIN_URI "http://moddevices.com/plugins/mod-devel/System-NoiseGate-" STRINGIFY(GATE_CHANNELS) "ch"
+
+// attack and hold are fixed, same as the stereo system gate
+#define ATTACK_TIME 10
+#define HOLD_TIME 1
+
+typedef enum {
+    PLUGIN_INPUT_1   = 0,
+    PLUGIN_OUTPUT_1  = GATE_CHANNELS,
+    PLUGIN_THRESHOLD = 2 * GATE_CHANNELS,
+    PLUGIN_DECAY
+}PortIndex;
+
+/**********************************************************************************************************************************************************/
+
+typedef struct{
+
+    //ports
+    const float*    input[GATE_CHANNELS];
+    float*         output[GATE_CHANNELS];
+    float*          threshold;
+    float*              decay;
+
+    uint32_t     sampleRate;
+
+    // holds this struct and the gate buffers
+    dsp_arena_t arena;
+
+    gate_t noisegate DSP_CACHE_ALIGNED;
+
+} NoiseGate;
+
+/**********************************************************************************************************************************************************/
+//                                                                 local functions                                                                        //
+/**********************************************************************************************************************************************************/
+
+/**********************************************************************************************************************************************************/
+static LV2_Handle
+instantiate(const LV2_Descriptor*   descriptor,
+double                              samplerate,
+const char*                         bundle_path,
+const LV2_Feature* const* features)
+{
+    const uint32_t sampleRate = (uint32_t)samplerate;
+    const uint32_t decimation = Gate_KeyDecimation(sampleRate);
+
+    dsp_arena_t arena;
+    if (!dsp_arena_init(&arena, DSP_ARENA_SIZE(sizeof(NoiseGate))
+                        + Gate_MemorySize(sampleRate, GATE_DEFAULT_WINDOW_MS, 1, decimation, 0)))
+        return NULL;
+
+    NoiseGate* self = (NoiseGate*)dsp_arena_alloc(&arena, sizeof(NoiseGate));
+    self->arena = arena;
+
+    self->sampleRate = sampleRate;
+
+    //all channels share the detector of the linked key
+    if (!Gate_Init(&self->noisegate, self->sampleRate, GATE_DEFAULT_WINDOW_MS, 1,
+                   decimation, &self->arena))
+    {
+        dsp_arena_free(&self->arena);
+        return NULL;
+    }
+
+#ifdef DSP_STATS
+    self->noisegate.stats = dsp_stats_open(PLUGIN_URI, self->sampleRate);
+#endif
+
+    return (LV2_Handle)self;
+}
+/**********************************************************************************************************************************************************/
+static void connect_port(LV2_Handle instance, uint32_t port, void *data)
+{
+    NoiseGate* self = (NoiseGate*)instance;
+
+    if (port < PLUGIN_OUTPUT_1)
+    {
+        self->input[port - PLUGIN_INPUT_1] = (const float*) data;
+        return;
+    }
+
+    if (port < PLUGIN_THRESHOLD)
+    {
+        self->output[port - PLUGIN_OUTPUT_1] = (float*) data;
+        return;
+    }
+
+    switch (port)
+    {
+        case PLUGIN_THRESHOLD:
+            self->threshold = (float*) data;
+            break;
+        case PLUGIN_DECAY:
+            self->decay = (float*) data;
+            break;
+    }
+}
+/**********************************************************************************************************************************************************/
+static void activate(LV2_Handle instance)
+{
+}
+
+/**********************************************************************************************************************************************************/
+static void run(LV2_Handle instance, uint32_t n_samples)
+{
+    NoiseGate* self = (NoiseGate*)instance;
+    DSP_STATS_RUN_BEGIN(stats_start);
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
+
+    //update parameters
+    //lower threshold is 20dB lower
+    Gate_UpdateParameters(&self->noisegate, (uint32_t)self->sampleRate, ATTACK_TIME, HOLD_TIME,
+                         (uint32_t)*self->decay, 1, *self->threshold, *self->threshold - 20.0f);
+
+    Gate_RunBlockLinked(&self->noisegate, self->input, self->output, GATE_CHANNELS, n_samples);
+
+    dsp_telemetry_publish(&self->noisegate.telemetry, n_samples);
+    DSP_STATS_RUN_END(self->noisegate.stats, stats_start, n_samples);
+    dsp_denormals_restore(fpmode);
+}
+
+/**********************************************************************************************************************************************************/
+static void deactivate(LV2_Handle instance)
+{
+}
+/**********************************************************************************************************************************************************/
+static void cleanup(LV2_Handle instance)
+{
+    NoiseGate* self = (NoiseGate*)instance;
+
+#ifdef DSP_STATS
+    dsp_stats_close(self->noisegate.stats);
+#endif
+    Gate_Cleanup(&self->noisegate);
+    dsp_arena_free(&self->arena);
+}
+/**********************************************************************************************************************************************************/
+static int telemetry_read(void* instance, dsp_telemetry_values_t* values, int restart)
+{
+    NoiseGate* self = (NoiseGate*)instance;
+
+    return dsp_telemetry_read(&self->noisegate.telemetry, values, restart);
+}
+/**********************************************************************************************************************************************************/
+static const void* extension_data(const char* uri)
+{
+    if (strcmp(uri, DSP_TELEMETRY__interface) == 0)
+    {
+        static const dsp_telemetry_interface_t telemetry = { telemetry_read };
+        return &telemetry;
+    }
+    return NULL;
+}
+/**********************************************************************************************************************************************************/
+static const LV2_Descriptor Descriptor = {
+    PLUGIN_URI,
+    instantiate,
+    connect_port,
+    activate,
+    run,
+    deactivate,
+    cleanup,
+    extension_data
+};
+/**********************************************************************************************************************************************************/
+LV2_SYMBOL_EXPORT
+const LV2_Descriptor* lv2_descriptor(uint32_t index)
+{
+    if (index == 0) return &Descriptor;
+    else return NULL;
+}
+/**********************************************************************************************************************************************************/
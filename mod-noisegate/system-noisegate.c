@@ -21,7 +21,8 @@
 #include <stdbool.h>
 #include "lv2/lv2plug.in/ns/lv2core/lv2.h"
 
-#include "gate_core.h"
+#include "dynamics.h"
+#include "dsp_denormal.h"
 
 /**********************************************************************************************************************************************************/
 
@@ -34,7 +35,9 @@ typedef enum {
     PLUGIN_OUTPUT_2,
     PLUGIN_GATE_MODE,
     PLUGIN_THRESHOLD,
-    PLUGIN_DECAY
+    PLUGIN_DECAY,
+    PLUGIN_LOOKAHEAD,
+    PLUGIN_LATENCY
 }PortIndex;
 
 /**********************************************************************************************************************************************************/
@@ -49,10 +52,14 @@ typedef struct{
     float*          gate_mode;
     float*          threshold;
     float*              decay;
+    float*          lookahead;
+    float*            latency;
 
-    uint32_t     sampleRate;
+    // holds this struct and the gate buffers
+    dsp_arena_t arena;
 
-    gate_t noisegate;
+    // channel modes, lookahead and the gate state, see dsp/dynamics.h
+    dynamics_gate_t noisegate;
 
 } NoiseGate;
 
@@ -67,11 +74,24 @@ double                              samplerate,
 const char*                         bundle_path,
 const LV2_Feature* const* features)
 {
-    NoiseGate* self = (NoiseGate*)malloc(sizeof(NoiseGate));
+    const uint32_t sampleRate = (uint32_t)samplerate;
 
-    self->sampleRate = (uint32_t)samplerate;
+    dsp_arena_t arena;
+    if (!dsp_arena_init(&arena, DSP_ARENA_SIZE(sizeof(NoiseGate)) + dynamics_gate_memory_size(sampleRate)))
+        return NULL;
 
-    Gate_Init(&self->noisegate);
+    NoiseGate* self = (NoiseGate*)dsp_arena_alloc(&arena, sizeof(NoiseGate));
+    self->arena = arena;
+
+    if (!dynamics_gate_init(&self->noisegate, sampleRate, &self->arena))
+    {
+        dsp_arena_free(&self->arena);
+        return NULL;
+    }
+
+#ifdef DSP_STATS
+    self->noisegate.gate.stats = dsp_stats_open(PLUGIN_URI, sampleRate);
+#endif
 
     return (LV2_Handle)self;
 }
@@ -103,73 +123,69 @@ static void connect_port(LV2_Handle instance, uint32_t port, void *data)
         case PLUGIN_DECAY:
             self->decay = (float*) data;
             break;
+        case PLUGIN_LOOKAHEAD:
+            self->lookahead = (float*) data;
+            break;
+        case PLUGIN_LATENCY:
+            self->latency = (float*) data;
+            break;
     }
 }
 /**********************************************************************************************************************************************************/
-void activate(LV2_Handle instance)
+static void activate(LV2_Handle instance)
 {
     // TODO: include the activate function code here
 }
 
 /**********************************************************************************************************************************************************/
-void run(LV2_Handle instance, uint32_t n_samples)
+static void run(LV2_Handle instance, uint32_t n_samples)
 {
     NoiseGate* self = (NoiseGate*)instance;    
+    DSP_STATS_RUN_BEGIN(stats_start);
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
 
-    //update parameters
-    //lower threshold is 20dB lower
-    Gate_UpdateParameters(&self->noisegate, (uint32_t)self->sampleRate, 10, 1,
-                         (uint32_t)*self->decay, 1, *self->threshold, *self->threshold - 20.0f);
+    const uint32_t latency = dynamics_gate_run(&self->noisegate, self->input_1, self->input_2, self->output_1, self->output_2,
+                                               n_samples, *self->gate_mode, *self->threshold, *self->decay, *self->lookahead);
 
+    if (self->latency)
+        *self->latency = (float)latency;
 
-    for (uint32_t i = 0; i < n_samples; ++i)
-    {
-    	switch((int)*self->gate_mode)
-    	{
-    		//off, copy 1 & 2
-    		case 0:
-    			self->output_1[i] = self->input_1[i];
-    			self->output_2[i] = self->input_2[i];
-    		break;
-
-    		//inp 1 only, copy 2
-    		case 1:
-                Gate_PushSamples(&self->noisegate, self->input_1[i], 0.f);
-    			self->output_1[i] = Gate_RunGate(&self->noisegate, self->input_1[i]);
-    			self->output_2[i] = self->input_2[i];
-    		break;
-
-    		//inp 2 only, copy 1
-    		case 2:
-                Gate_PushSamples(&self->noisegate, 0.f, self->input_2[i]);
-    			self->output_2[i] = Gate_RunGate(&self->noisegate, self->input_2[i]);
-    			self->output_1[i] = self->input_1[i];
-    		break;
-    	
-    		//we only run the gate once, for the other just multiply
-            //stereo is handled when pushing the samples to get the highest key
-    		case 3:
-                Gate_PushSamples(&self->noisegate, self->input_1[i], self->input_2[i]);
-    			self->output_1[i] = Gate_RunGate(&self->noisegate, self->input_1[i]);
-    			self->output_2[i] = Gate_ApplyGate(&self->noisegate, self->input_2[i]);
-    		break;
-    	}
-    }
+    dsp_telemetry_publish(&self->noisegate.gate.telemetry, n_samples);
+    DSP_STATS_RUN_END(self->noisegate.gate.stats, stats_start, n_samples);
+    dsp_denormals_restore(fpmode);
 }
 
 /**********************************************************************************************************************************************************/
-void deactivate(LV2_Handle instance)
+static void deactivate(LV2_Handle instance)
 {
     // TODO: include the deactivate function code here
 }
 /**********************************************************************************************************************************************************/
-void cleanup(LV2_Handle instance)
+static void cleanup(LV2_Handle instance)
 {
-    free(instance);
+    NoiseGate* self = (NoiseGate*)instance;
+
+#ifdef DSP_STATS
+    dsp_stats_close(self->noisegate.gate.stats);
+#endif
+    dynamics_gate_cleanup(&self->noisegate);
+    dsp_arena_free(&self->arena);
 }
 /**********************************************************************************************************************************************************/
-const void* extension_data(const char* uri)
+static int telemetry_read(void* instance, dsp_telemetry_values_t* values, int restart)
 {
+    NoiseGate* self = (NoiseGate*)instance;
+
+    return dsp_telemetry_read(&self->noisegate.gate.telemetry, values, restart);
+}
+/**********************************************************************************************************************************************************/
+static const void* extension_data(const char* uri)
+{
+    if (strcmp(uri, DSP_TELEMETRY__interface) == 0)
+    {
+        static const dsp_telemetry_interface_t telemetry = { telemetry_read };
+        return &telemetry;
+    }
     return NULL;
 }
 /**********************************************************************************************************************************************************/
@@ -184,10 +200,18 @@ static const LV2_Descriptor Descriptor = {
     extension_data
 };
 /**********************************************************************************************************************************************************/
+#ifdef PLUGIN_COMBINED
+//the combined bundle in mod-combined exports all system plugins from one binary
+const LV2_Descriptor* system_noisegate_descriptor(void)
+{
+    return &Descriptor;
+}
+#else
 LV2_SYMBOL_EXPORT
 const LV2_Descriptor* lv2_descriptor(uint32_t index)
 {
     if (index == 0) return &Descriptor;
     else return NULL;
 }
+#endif
 /**********************************************************************************************************************************************************/
@@ -0,0 +1,532 @@
+/*
+ * mod-system-plugins tools
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// renders audio files offline through the system noisegate followed by the system compressor, the
+// chain of every MOD system input. It runs the same dsp/dynamics.c code as the plugins, at a fixed
+// block size and in the floating point mode of their run(), so every output matches what the two
+// plugins produce at that block size, bit for bit, however many files run in parallel.
+// Inputs are WAV (16/24/32 bit integer or 32 bit float, mono or stereo) or .raw interleaved stereo
+// 32 bit float; outputs are 32 bit float stereo of the same kind, with the gate latency left in.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "dynamics.h"
+#include "dsp_denormal.h"
+
+#define BATCH_MAX_BLOCK 4096
+// input mapped ahead of the block being rendered, pages behind it are dropped again
+#define BATCH_READAHEAD (4 << 20)
+#define BATCH_PATH_SIZE 4096
+
+typedef enum {
+    SAMPLE_INT16,
+    SAMPLE_INT24,
+    SAMPLE_INT32,
+    SAMPLE_FLOAT32
+} sample_format_t;
+
+typedef struct {
+    //chain controls, named and ranged as in the plugin TTLs
+    float gate_mode, threshold, decay, lookahead;
+    float comp_mode, release, volume;
+    uint32_t block;
+    uint32_t raw_rate;
+    const char *outdir;
+} batch_options_t;
+
+typedef struct {
+    double seconds;     //audio length
+    double elapsed;     //wall time
+    int failed;
+} batch_result_t;
+
+typedef struct {
+    const batch_options_t *options;
+    char **files;
+    batch_result_t *results;
+    uint32_t count;
+    uint32_t next;      //next file to take, shared by the workers
+} batch_t;
+
+typedef struct {
+    const uint8_t *map;
+    size_t map_size;
+    const uint8_t *data;
+    uint64_t frames;
+    uint32_t channels;
+    uint32_t rate;
+    uint32_t frame_size;
+    sample_format_t format;
+    int raw;
+} input_t;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static int has_suffix(const char *path, const char *suffix)
+{
+    const size_t length = strlen(path), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcasecmp(path + length - suffix_length, suffix) == 0;
+}
+
+// --------------------------------------------------------------
+// input
+
+static int wav_parse(input_t *input, const char *path)
+{
+    const uint8_t *p = input->map, *end = input->map + input->map_size;
+    uint32_t tag = 0, bits = 0;
+    int have_format = 0;
+
+    if (input->map_size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+    {
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        return 0;
+    }
+
+    for (p += 12; p + 8 <= end; )
+    {
+        const uint32_t size = le32(p + 4);
+        const uint8_t *body = p + 8;
+
+        if (memcmp(p, "fmt ", 4) == 0 && size >= 16 && body + size <= end)
+        {
+            tag = le16(body);
+            input->channels = le16(body + 2);
+            input->rate = le32(body + 4);
+            bits = le16(body + 14);
+            //WAVE_FORMAT_EXTENSIBLE keeps the real format at the start of the sub format GUID
+            if (tag == 0xFFFE && size >= 26)
+                tag = le16(body + 24);
+            have_format = 1;
+        }
+        else if (memcmp(p, "data", 4) == 0 && have_format)
+        {
+            //a streamed WAV may leave the data size open, take what is there
+            const size_t available = (size_t)(end - body);
+            input->data = body;
+            input->frame_size = input->channels * (bits / 8);
+            input->frames = input->frame_size ? ((size < available) ? size : available) / input->frame_size : 0;
+            break;
+        }
+
+        p = body + size + (size & 1);
+    }
+
+    if (!input->data || input->channels < 1 || input->channels > 2 || input->rate == 0)
+    {
+        fprintf(stderr, "%s: unsupported WAV, mono or stereo PCM or float data is needed\n", path);
+        return 0;
+    }
+
+    if (tag == 1 && bits == 16)
+        input->format = SAMPLE_INT16;
+    else if (tag == 1 && bits == 24)
+        input->format = SAMPLE_INT24;
+    else if (tag == 1 && bits == 32)
+        input->format = SAMPLE_INT32;
+    else if (tag == 3 && bits == 32)
+        input->format = SAMPLE_FLOAT32;
+    else
+    {
+        fprintf(stderr, "%s: unsupported sample format %u/%u bit\n", path, tag, bits);
+        return 0;
+    }
+
+    return 1;
+}
+
+static int input_open(input_t *input, const char *path, const batch_options_t *options)
+{
+    struct stat st;
+    const int fd = open(path, O_RDONLY);
+
+    memset(input, 0, sizeof(*input));
+
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+
+    input->map_size = (size_t)st.st_size;
+    input->map = (const uint8_t *)mmap(NULL, input->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (input->map == MAP_FAILED)
+    {
+        perror(path);
+        input->map = NULL;
+        return 0;
+    }
+
+    madvise((void *)input->map, input->map_size, MADV_SEQUENTIAL);
+
+    if (has_suffix(path, ".raw"))
+    {
+        input->raw = 1;
+        input->data = input->map;
+        input->channels = 2;
+        input->rate = options->raw_rate;
+        input->format = SAMPLE_FLOAT32;
+        input->frame_size = 2 * sizeof(float);
+        input->frames = input->map_size / input->frame_size;
+        return 1;
+    }
+
+    return wav_parse(input, path);
+}
+
+static void input_close(input_t *input)
+{
+    if (input->map)
+        munmap((void *)input->map, input->map_size);
+}
+
+static float sample_read(const uint8_t *p, sample_format_t format)
+{
+    switch (format)
+    {
+        case SAMPLE_INT16:
+            return (float)(int16_t)le16(p) * (1.0f / 32768.0f);
+        case SAMPLE_INT24:
+            return (float)((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8)
+                   * (1.0f / 8388608.0f);
+        case SAMPLE_INT32:
+            return (float)(int32_t)le32(p) * (1.0f / 2147483648.0f);
+        case SAMPLE_FLOAT32:
+        default:
+        {
+            float value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+    }
+}
+
+//deinterleaves one block, a mono input feeds both channels
+static void input_read(const input_t *input, uint64_t frame, uint32_t n, float *left, float *right)
+{
+    const uint32_t sample_size = input->frame_size / input->channels;
+    const uint8_t *p = input->data + frame * input->frame_size;
+
+    for (uint32_t i = 0; i < n; i++, p += input->frame_size)
+    {
+        left[i] = sample_read(p, input->format);
+        right[i] = (input->channels == 2) ? sample_read(p + sample_size, input->format) : left[i];
+    }
+}
+
+//keeps the mapping bounded: asks for the next window and drops the pages already rendered
+static void input_advance(const input_t *input, uint64_t frame, uint64_t *ahead)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t offset = (size_t)(input->data - input->map) + frame * input->frame_size;
+
+    if (offset + BATCH_READAHEAD / 2 < *ahead || *ahead >= input->map_size)
+        return;
+
+    const size_t start = *ahead & ~(page - 1);
+    const size_t length = (start + BATCH_READAHEAD < input->map_size) ? BATCH_READAHEAD : input->map_size - start;
+    madvise((void *)(input->map + start), length, MADV_WILLNEED);
+    *ahead = start + length;
+
+    const size_t done = offset & ~(page - 1);
+    if (done > 0)
+        madvise((void *)input->map, done, MADV_DONTNEED);
+}
+
+// --------------------------------------------------------------
+// output
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = v >> 24;
+}
+
+static void put16(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+}
+
+static int wav_header(FILE *file, uint64_t frames, uint32_t rate)
+{
+    const uint64_t bytes = frames * 2 * sizeof(float);
+    uint8_t header[44];
+
+    if (bytes > 0xFFFFFFFFull - 36)
+        return 0;
+
+    memcpy(header, "RIFF", 4);
+    put32(header + 4, (uint32_t)(36 + bytes));
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(header + 16, 16);
+    put16(header + 20, 3);          //IEEE float
+    put16(header + 22, 2);
+    put32(header + 24, rate);
+    put32(header + 28, rate * 2 * sizeof(float));
+    put16(header + 32, 2 * sizeof(float));
+    put16(header + 34, 32);
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, (uint32_t)bytes);
+
+    return fwrite(header, sizeof(header), 1, file) == 1;
+}
+
+static void output_path(char *path, const char *outdir, const char *input, int raw)
+{
+    const char *name = strrchr(input, '/');
+    name = name ? name + 1 : input;
+
+    const char *dot = strrchr(name, '.');
+    const int length = dot ? (int)(dot - name) : (int)strlen(name);
+
+    snprintf(path, BATCH_PATH_SIZE, "%s/%.*s%s", outdir, length, name, raw ? ".raw" : ".wav");
+}
+
+// --------------------------------------------------------------
+// rendering
+
+static int render_file(const batch_options_t *options, const char *path, batch_result_t *result)
+{
+    static __thread float in_l[BATCH_MAX_BLOCK], in_r[BATCH_MAX_BLOCK];
+    static __thread float out_l[BATCH_MAX_BLOCK], out_r[BATCH_MAX_BLOCK];
+    static __thread float interleaved[2 * BATCH_MAX_BLOCK];
+    char out_path[BATCH_PATH_SIZE];
+    dynamics_gate_t gate;
+    dynamics_compressor_t compressor;
+    dsp_arena_t arena;
+    input_t input;
+    int ok = 1;
+
+    if (!input_open(&input, path, options))
+        return 0;
+
+    output_path(out_path, options->outdir, path, input.raw);
+    result->seconds = (double)input.frames / input.rate;
+
+    FILE *file = fopen(out_path, "wb");
+    if (!file)
+    {
+        perror(out_path);
+        input_close(&input);
+        return 0;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    if (!input.raw && !wav_header(file, input.frames, input.rate))
+    {
+        fprintf(stderr, "%s: too long for a WAV output, use .raw\n", path);
+        fclose(file);
+        input_close(&input);
+        return 0;
+    }
+
+    //fresh instances per file, so a file renders the same whichever worker takes it
+    if (!dsp_arena_init(&arena, dynamics_gate_memory_size(input.rate) + dynamics_compressor_memory_size(options->block))
+        || !dynamics_gate_init(&gate, input.rate, &arena)
+        || !dynamics_compressor_init(&compressor, input.rate, options->block, &arena))
+    {
+        fprintf(stderr, "%s: out of memory\n", path);
+        dsp_arena_free(&arena);
+        fclose(file);
+        input_close(&input);
+        return 0;
+    }
+
+    uint64_t ahead = 0;
+
+    for (uint64_t frame = 0; frame < input.frames && ok; frame += options->block)
+    {
+        const uint32_t n = (input.frames - frame < options->block) ? (uint32_t)(input.frames - frame) : options->block;
+
+        input_advance(&input, frame, &ahead);
+        input_read(&input, frame, n, in_l, in_r);
+
+        dynamics_gate_run(&gate, in_l, in_r, out_l, out_r, n,
+                          options->gate_mode, options->threshold, options->decay, options->lookahead);
+        dynamics_compressor_run(&compressor, out_l, out_r, out_l, out_r, n,
+                                options->comp_mode, options->release, options->volume);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            interleaved[2 * i] = out_l[i];
+            interleaved[2 * i + 1] = out_r[i];
+        }
+
+        ok = fwrite(interleaved, 2 * sizeof(float), n, file) == n;
+    }
+
+    dynamics_gate_cleanup(&gate);
+    dynamics_compressor_cleanup(&compressor);
+    dsp_arena_free(&arena);
+    input_close(&input);
+
+    if (fclose(file) != 0 || !ok)
+    {
+        perror(out_path);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void *worker(void *arg)
+{
+    batch_t *batch = (batch_t *)arg;
+    //the plugins render with denormals flushed, see dsp/dsp_denormal.h
+    const dsp_fpmode_t fpmode = dsp_denormals_disable();
+
+    for (;;)
+    {
+        const uint32_t index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+        if (index >= batch->count)
+            break;
+
+        batch_result_t *result = &batch->results[index];
+        const double start = now();
+        result->failed = !render_file(batch->options, batch->files[index], result);
+        result->elapsed = now() - start;
+    }
+
+    dsp_denormals_restore(fpmode);
+    return NULL;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s -o output-dir [-j jobs] [-b block] [-r raw-rate]\n"
+                    "          [-g gate-mode] [-T threshold] [-d decay] [-l]\n"
+                    "          [-m comp-mode] [-R release] [-v volume] input...\n"
+                    "  gate:       -g 0 off, 1 in 1, 2 in 2, 3 stereo (3), -T dB (-60), -d ms (10), -l lookahead\n"
+                    "  compressor: -m 0 bypass, 1 light, 2 mild, 3 heavy, 4 extreme (1), -R ms (100), -v dB (0)\n"
+                    "  -b is the host block size the plugins would run at (256), -r the rate of .raw inputs (48000)\n",
+                    name);
+}
+
+int main(int argc, char **argv)
+{
+    batch_options_t options = {
+        .gate_mode = DYNAMICS_GATE_STEREO, .threshold = -60.0f, .decay = 10.0f, .lookahead = 0.0f,
+        .comp_mode = DYNAMICS_COMP_LIGHT, .release = 100.0f, .volume = 0.0f,
+        .block = DYNAMICS_COMP_BLOCK, .raw_rate = 48000, .outdir = NULL,
+    };
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:j:b:r:g:T:d:lm:R:v:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': options.outdir = optarg; break;
+            case 'j': jobs = atol(optarg); break;
+            case 'b': options.block = (uint32_t)atoi(optarg); break;
+            case 'r': options.raw_rate = (uint32_t)atoi(optarg); break;
+            case 'g': options.gate_mode = (float)atoi(optarg); break;
+            case 'T': options.threshold = (float)atof(optarg); break;
+            case 'd': options.decay = (float)atof(optarg); break;
+            case 'l': options.lookahead = 1.0f; break;
+            case 'm': options.comp_mode = (float)atoi(optarg); break;
+            case 'R': options.release = (float)atof(optarg); break;
+            case 'v': options.volume = (float)atof(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (!options.outdir || optind >= argc || options.block < 1 || options.block > BATCH_MAX_BLOCK
+        || options.raw_rate == 0 || options.gate_mode < 0 || options.gate_mode > 3
+        || options.comp_mode < 0 || options.comp_mode > 4)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    batch_t batch;
+    batch.options = &options;
+    batch.files = argv + optind;
+    batch.count = (uint32_t)(argc - optind);
+    batch.next = 0;
+    batch.results = (batch_result_t *)calloc(batch.count, sizeof(batch_result_t));
+
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > (long)batch.count)
+        jobs = batch.count;
+
+    pthread_t *threads = (pthread_t *)calloc((size_t)jobs, sizeof(pthread_t));
+    if (!batch.results || !threads)
+        return 1;
+
+    const double start = now();
+
+    for (long j = 0; j < jobs; j++)
+    {
+        if (pthread_create(&threads[j], NULL, worker, &batch) != 0)
+        {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+
+    for (long j = 0; j < jobs; j++)
+        pthread_join(threads[j], NULL);
+
+    const double elapsed = now() - start;
+    double total = 0.0;
+    int failed = 0;
+
+    for (uint32_t i = 0; i < batch.count; i++)
+    {
+        const batch_result_t *result = &batch.results[i];
+
+        if (result->failed)
+        {
+            printf("%-40s failed\n", batch.files[i]);
+            failed++;
+            continue;
+        }
+
+        total += result->seconds;
+        printf("%-40s %10.1f s %10.1fx realtime\n", batch.files[i], result->seconds,
+               result->elapsed > 0.0 ? result->seconds / result->elapsed : 0.0);
+    }
+
+    printf("%u files, %.1f s of audio in %.2f s with %ld jobs, %.1fx realtime\n", batch.count - failed, total,
+           elapsed, jobs, elapsed > 0.0 ? total / elapsed : 0.0);
+
+    free(threads);
+    free(batch.results);
+    return failed ? 1 : 0;
+}
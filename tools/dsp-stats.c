@@ -0,0 +1,126 @@
+/*
+ * mod-system-plugins tools
+ * Copyright (C) 2022 MOD Devices
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// prints the hot path counters of the plugins in a running host, needs a STATS=true build
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "dsp_stats.h"
+
+//sequence lock read, retried while the audio thread is in the middle of publishing
+static int read_slot(const dsp_stats_slot_t *slot, dsp_stats_counters_t *counters, char *uri)
+{
+    for (int attempt = 0; attempt < 1000; attempt++)
+    {
+        const uint32_t before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+        if (before & 1)
+            continue;
+
+        memcpy(counters, (const void *)&slot->counters, sizeof(*counters));
+        memcpy(uri, slot->uri, DSP_STATS_URI_SIZE);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == before)
+        {
+            uri[DSP_STATS_URI_SIZE - 1] = '\0';
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static double percent(uint64_t part, uint64_t total)
+{
+    return total ? 100.0 * (double)part / (double)total : 0.0;
+}
+
+static void print_table(const dsp_stats_shm_t *table)
+{
+    const double us_per_tick = 1e6 / (double)table->tick_rate;
+
+    printf("%-4s %-28s %10s %9s %9s %8s %8s %7s %7s %7s %8s\n", "slot", "plugin", "runs", "avg us", "max us",
+           "params", "fast %", "idle %", "hold %", "decay %", "trans");
+
+    for (uint32_t i = 0; i < DSP_STATS_MAX_SLOTS; i++)
+    {
+        dsp_stats_counters_t c;
+        char uri[DSP_STATS_URI_SIZE];
+
+        if (!__atomic_load_n(&table->slot[i].in_use, __ATOMIC_ACQUIRE) || !read_slot(&table->slot[i], &c, uri))
+            continue;
+
+        const char *name = strrchr(uri, '/');
+        const uint64_t steps = c.gate_steps[0] + c.gate_steps[1] + c.gate_steps[2];
+
+        printf("%-4u %-28s %10llu %9.2f %9.2f %8llu %8.1f %7.1f %7.1f %7.1f %8llu\n", i, name ? name + 1 : uri,
+               (unsigned long long)c.runs, c.runs ? c.run_ticks * us_per_tick / c.runs : 0.0,
+               c.run_ticks_max * us_per_tick, (unsigned long long)c.set_params,
+               percent(c.chunks_fast, c.chunks_fast + c.chunks_full), percent(c.gate_steps[0], steps),
+               percent(c.gate_steps[1], steps), percent(c.gate_steps[2], steps),
+               (unsigned long long)c.gate_transitions);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    char name[64];
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <host-pid> [interval-ms]\n", argv[0]);
+        return 1;
+    }
+
+    const int interval = argc > 2 ? atoi(argv[2]) : 0;
+    snprintf(name, sizeof(name), DSP_STATS_SHM_PREFIX "%d", atoi(argv[1]));
+
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror(name);
+        return 1;
+    }
+
+    const dsp_stats_shm_t *table = (const dsp_stats_shm_t *)mmap(NULL, sizeof(dsp_stats_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (table == MAP_FAILED || table->magic != DSP_STATS_MAGIC || table->version != DSP_STATS_VERSION)
+    {
+        fprintf(stderr, "%s is not a stats table of this version\n", name);
+        return 1;
+    }
+
+    do
+    {
+        print_table(table);
+
+        if (interval > 0)
+        {
+            usleep((useconds_t)interval * 1000);
+            printf("\n");
+        }
+    }
+    while (interval > 0);
+
+    return 0;
+}